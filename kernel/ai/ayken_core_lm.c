@@ -4,7 +4,7 @@
 #include "ayken_core_lm_format.h"
 #include "../include/fs.h"              // vfs_open, vfs_read, vfs_close
 
-#define AYKEN_CORE_LM_BASE_VA  0xFFFFA00000000000ULL
+#define AYKEN_CORE_LM_BASE_VA  CORE_LM_WINDOW_BASE   // PML4[320], bkz. mm.h
 #define AYKEN_CORE_LM_MAX_SIZE (64ULL * 1024 * 1024)  // max 64MB model
 
 static lm_model_t core_model;
@@ -16,23 +16,18 @@ static uint8_t *g_weights_base = NULL;  // sadece weights bloğunun başlangıc
 static ayken_lm_tensor_desc_t *g_tensors     = NULL;
 static uint32_t                g_tensor_count = 0;
 
-// virt tarafta ardışık bir bölge ayır + map et
+// virt tarafta ardışık bir bölge ayır + map et.
+// Ağırlıklar her inference'ta baştan sona taranır: mümkün olan her 2MB
+// dilim tek bir büyük sayfa (TLB girişi) olur, gerisi 4KB batch'ler.
 static void* ayken_core_lm_map_region(uint64_t size_bytes)
 {
-    uint64_t pages = (size_bytes + PAGE_SIZE - 1) / PAGE_SIZE;
-
+    uint64_t size    = (size_bytes + AYKEN_FRAME_SIZE - 1) & ~(AYKEN_FRAME_SIZE - 1);
     uint64_t base_va = AYKEN_CORE_LM_BASE_VA;
 
-    for (uint64_t i = 0; i < pages; i++) {
-        uint64_t phys = phys_alloc_frame();
-        if (!phys) {
-            fb_print("[AykenCoreLM] phys_alloc_frame() FAILED!\n");
-            return NULL;
-        }
-
-        uint64_t va = base_va + i * PAGE_SIZE;
-        // user bit yok, sadece kernel: flags = 0
-        paging_map(va, phys, 0);
+    // user bit yok, sadece kernel: flags = 0
+    if (paging_map_anon(base_va, size, 0) != 0) {
+        fb_print("[AykenCoreLM] phys_alloc_frame() FAILED!\n");
+        return NULL;
     }
 
     return (void*)base_va;
@@ -8,6 +8,7 @@
 #include "ayken_core_lm_format.h"
 #include "lm_tokenizer.h"
 #include "../drivers/console/fb_console.h"
+#include "../include/mm.h"
 
 // =========================
 // Sabitler / sınırlar
@@ -17,10 +18,18 @@
 #define LM_MAX_CTX       256
 #define LM_MAX_HIDDEN    512   // tiny model için güvenlik sınırı
 
-// Çalışma buffer'ları
-static int   g_tokens[LM_MAX_TOKENS];
-static float g_hidden[LM_MAX_HIDDEN];
-static float g_logits[LM_MAX_HIDDEN];
+// Inference başına scratch: token/hidden/logits ve katman buffer'ları
+// buradan alınır, lm_infer sonunda arena_reset ile topluca geri verilir.
+// (Katman buffer'ları eskiden stack'te ~10 KB yer kaplıyordu.)
+#define LM_SCRATCH_SIZE  (64 * 1024)
+
+static arena_t g_lm_arena;
+static int     g_lm_arena_ready = 0;
+
+static float *lm_scratch_vec(int n)
+{
+    return (float*)arena_alloc(&g_lm_arena, (uint64_t)n * sizeof(float), 64);
+}
 
 
 
@@ -231,12 +240,18 @@ static void lm_run_layer(const lm_model_t *m, float *hidden, int layer_idx)
     const void *W_f1 = ayken_core_lm_get_tensor_data(td_ff1);
     const void *W_f2 = ayken_core_lm_get_tensor_data(td_ff2);
 
-    // --- Çalışma buffer'ları ---
-    float q[LM_MAX_HIDDEN];
-    float k[LM_MAX_HIDDEN];
-    float v[LM_MAX_HIDDEN];
-    float att_out[LM_MAX_HIDDEN];
-    float ff_tmp[LM_MAX_HIDDEN];
+    // --- Çalışma buffer'ları (katman sonunda geri alınır) ---
+    arena_mark_t mark = arena_mark(&g_lm_arena);
+
+    float *q       = lm_scratch_vec(h);
+    float *k       = lm_scratch_vec(h);
+    float *v       = lm_scratch_vec(h);
+    float *att_out = lm_scratch_vec(h);
+    float *ff_tmp  = lm_scratch_vec(h);
+    if (!q || !k || !v || !att_out || !ff_tmp) {
+        arena_rewind(&g_lm_arena, mark);
+        return;
+    }
 
     // 1) Q/K/V projeksiyonları
     lm_matmul_qx(m, W_q, hidden, h, h, q);
@@ -269,6 +284,8 @@ static void lm_run_layer(const lm_model_t *m, float *hidden, int layer_idx)
     //  - Residual bağlantı (x + f(x))
     //  - LayerNorm
     // Şimdilik bu kısım atlanıyor (hidden doğrudan güncellendi).
+
+    arena_rewind(&g_lm_arena, mark);
 }
 
 // 3) Tüm katmanları çalıştır
@@ -323,27 +340,44 @@ int lm_infer(const char *prompt, char *out, int max_out)
         return -1;
     }
 
+    if (!g_lm_arena_ready) {
+        if (arena_init(&g_lm_arena, LM_SCRATCH_SIZE) != 0) {
+            fb_print("[AykenCoreLM][runtime] Scratch arena alloc failed.\n");
+            return -1;
+        }
+        g_lm_arena_ready = 1;
+    }
+
+    int *tokens   = (int*)arena_alloc(&g_lm_arena, LM_MAX_TOKENS * sizeof(int), 16);
+    float *hidden = lm_scratch_vec(LM_MAX_HIDDEN);
+    float *logits = lm_scratch_vec(LM_MAX_HIDDEN);
+    if (!tokens || !hidden || !logits) {
+        arena_reset(&g_lm_arena);
+        return -1;
+    }
+
     // 1) Prompt'u tokenize et
-    int n_tokens = lm_tokenize(prompt, g_tokens, LM_MAX_TOKENS);
+    int n_tokens = lm_tokenize(prompt, tokens, LM_MAX_TOKENS);
     if (n_tokens <= 0) {
         fb_print("[AykenCoreLM][runtime] Tokenization failed.\n");
+        arena_reset(&g_lm_arena);
         return -1;
     }
 
     // 2) Basit: sadece son token üzerinden tahmin
-    int last_token = g_tokens[n_tokens - 1];
+    int last_token = tokens[n_tokens - 1];
 
     int h = (int)m->hidden_size;
     if (h > LM_MAX_HIDDEN) h = LM_MAX_HIDDEN;
 
     // 3) Embedding
-    lm_embed_token(m, last_token, g_hidden);
+    lm_embed_token(m, last_token, hidden);
 
     // 4) Transformer katmanları
-    lm_run_transformer(m, g_hidden);
+    lm_run_transformer(m, hidden);
 
     // 5) Hidden -> logits
-    lm_hidden_to_logits(m, g_hidden, g_logits);
+    lm_hidden_to_logits(m, hidden, logits);
 
     // 6) Argmax ile bir sonraki token seç
     int vocab = (int)m->vocab_size;
@@ -351,7 +385,10 @@ int lm_infer(const char *prompt, char *out, int max_out)
         vocab = LM_MAX_HIDDEN;
     }
 
-    int next_token = lm_argmax(g_logits, vocab);
+    int next_token = lm_argmax(logits, vocab);
+
+    // Scratch'in tamamı tek adımda geri verilir
+    arena_reset(&g_lm_arena);
 
     // 7) Şimdilik 1 token -> 1 char üret
     if (max_out <= 0) return 0;
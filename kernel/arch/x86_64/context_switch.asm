@@ -20,8 +20,8 @@ context_switch:
     pushfq
     pop rax
     mov [rdi +64], rax
-    mov rax, cr3
-    mov [rdi +72], rax
+    mov r9, cr3
+    mov [rdi +72], r9
 
     ; Load new registers
     mov r15, [rsi + 0]
@@ -35,9 +35,15 @@ context_switch:
     mov rax, [rsi +48]    ; rip
     mov rcx, [rsi +56]    ; rsp
     mov rdx, [rsi +64]    ; rflags
-    mov r8,  [rsi +72]    ; cr3
+    mov r8,  [rsi +72]    ; cr3 (PCID + no-flush biti taşıyabilir)
 
+    ; Aynı adres alanına geçiyorsak CR3'e hiç yazma (TLB sıcak kalır)
+    mov r10, r8
+    btr r10, 63
+    cmp r9, r10
+    je .same_as
     mov cr3, r8
+.same_as:
 
     mov rsp, rcx
     push rdx
@@ -57,9 +63,15 @@ switch_to_first:
     mov rax, [rdi +48]    ; rip
     mov rcx, [rdi +56]    ; rsp
     mov rdx, [rdi +64]    ; rflags
-    mov r8,  [rdi +72]    ; cr3
+    mov r8,  [rdi +72]    ; cr3 (PCID + no-flush biti taşıyabilir)
 
+    mov r9, cr3
+    mov r10, r8
+    btr r10, 63
+    cmp r9, r10
+    je .same_as
     mov cr3, r8
+.same_as:
     mov rsp, rcx
     push rdx
     popfq
@@ -1,4 +1,6 @@
 #pragma once
+#include <stdint.h>
+#include "../../include/ayken.h"
 
 void cpu_init(void);
 
@@ -6,6 +8,105 @@ void cpu_init(void);
 static inline void enable_interrupts(void) { __asm__ volatile("sti" ::: "memory"); }
 static inline void disable_interrupts(void) { __asm__ volatile("cli" ::: "memory"); }
 
+// RFLAGS'i sakla + kesmeleri kapat; iç içe kritik bölgeler için
+static inline uint64_t cpu_irq_save(void)
+{
+    uint64_t flags;
+    __asm__ volatile("pushfq; pop %0; cli" : "=r"(flags) :: "memory");
+    return flags;
+}
+
+static inline void cpu_irq_restore(uint64_t flags)
+{
+    if (flags & (1ULL << 9)) // IF
+        enable_interrupts();
+}
+
+// Aktif GDT (firmware'in kurduğu olabilir)
+struct cpu_gdtr {
+    uint16_t limit;
+    uint64_t base;
+} __attribute__((packed));
+
+static inline uint64_t cpu_get_gdt_base(void)
+{
+    struct cpu_gdtr gdtr;
+    __asm__ volatile("sgdt %0" : "=m"(gdtr));
+    return gdtr.base;
+}
+
+static inline uint64_t cpu_get_gdt_limit(void)
+{
+    struct cpu_gdtr gdtr;
+    __asm__ volatile("sgdt %0" : "=m"(gdtr));
+    return gdtr.limit;
+}
+
+static inline void cpu_cpuid(uint32_t leaf, uint32_t *a, uint32_t *b,
+                             uint32_t *c, uint32_t *d)
+{
+    __asm__ volatile("cpuid"
+                     : "=a"(*a), "=b"(*b), "=c"(*c), "=d"(*d)
+                     : "a"(leaf), "c"(0));
+}
+
+// 1 GiB sayfa desteği (CPUID 0x80000001 EDX.Page1GB[26])
+static inline int cpu_has_1g_pages(void)
+{
+    uint32_t a, b, c, d;
+    cpu_cpuid(0x80000000u, &a, &b, &c, &d);
+    if (a < 0x80000001u)
+        return 0;
+    cpu_cpuid(0x80000001u, &a, &b, &c, &d);
+    return (d >> 26) & 1;
+}
+
+// Global sayfa desteği (CPUID 1 EDX.PGE[13])
+static inline int cpu_has_pge(void)
+{
+    uint32_t a, b, c, d;
+    cpu_cpuid(1, &a, &b, &c, &d);
+    return (d >> 13) & 1;
+}
+
+// Process-context identifier desteği (CPUID 1 ECX.PCID[17])
+static inline int cpu_has_pcid(void)
+{
+    uint32_t a, b, c, d;
+    cpu_cpuid(1, &a, &b, &c, &d);
+    return (c >> 17) & 1;
+}
+
+// Page Attribute Table desteği (CPUID 1 EDX.PAT[16])
+static inline int cpu_has_pat(void)
+{
+    uint32_t a, b, c, d;
+    cpu_cpuid(1, &a, &b, &c, &d);
+    return (d >> 16) & 1;
+}
+
+static inline uint64_t cpu_rdmsr(uint32_t msr)
+{
+    uint32_t lo, hi;
+    __asm__ volatile("rdmsr" : "=a"(lo), "=d"(hi) : "c"(msr));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static inline void cpu_wrmsr(uint32_t msr, uint64_t value)
+{
+    __asm__ volatile("wrmsr"
+                     :: "c"(msr), "a"((uint32_t)value), "d"((uint32_t)(value >> 32))
+                     : "memory");
+}
+
+// Çalışan CPU'nun 0..AYKEN_MAX_CPUS-1 indeksi.
+// AP'ler henüz başlatılmadığı için şimdilik yalnızca BSP (0) çalışıyor;
+// SMP bring-up ile per-CPU GS tabanından okunacak.
+static inline uint32_t cpu_current_id(void)
+{
+    return 0;
+}
+
 // Context switch routines (implemented in assembly)
 struct cpu_context;
 void context_switch(struct cpu_context *old_ctx, struct cpu_context *new_ctx);
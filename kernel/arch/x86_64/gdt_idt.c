@@ -28,9 +28,74 @@ static inline void lidt(void *base, uint16_t size)
     __asm__ volatile("lidt %0" : : "m"(IDTR));
 }
 
+// ---------------------------------------------------------------------------
+// GDT + TSS
+//
+// UEFI'nin GDT'sinde TSS yok; IST stack'leri için kendi GDT'mizi kuruyoruz:
+// null, 64-bit kernel code, kernel data ve 16 byte'lık TSS descriptor'ı.
+// TSS'in tek görevi IST girişleri (ring geçişi yok, RSP0 kullanılmıyor).
+// ---------------------------------------------------------------------------
+
+#define IST_STACK_SIZE  (16 * 1024)
+
+struct tss64 {
+    uint32_t reserved0;
+    uint64_t rsp[3];
+    uint64_t reserved1;
+    uint64_t ist[7];
+    uint64_t reserved2;
+    uint16_t reserved3;
+    uint16_t iomap_base;
+} __attribute__((packed));
+
+static uint64_t     g_gdt[5];
+static struct tss64 g_tss;
+
+static uint8_t g_ist_df_stack[IST_STACK_SIZE] __attribute__((aligned(16)));
+static uint8_t g_ist_pf_stack[IST_STACK_SIZE] __attribute__((aligned(16)));
+
 void gdt_init(void)
 {
-    // GDT setup placeholder (UEFI bootloader already provided a basic GDT)
+    g_gdt[0] = 0;
+    g_gdt[1] = 0x00AF9A000000FFFFULL;   // code: P, DPL0, L=1
+    g_gdt[2] = 0x00CF92000000FFFFULL;   // data: P, DPL0, RW
+
+    g_tss.ist[IST_DOUBLE_FAULT - 1] = (uint64_t)(g_ist_df_stack + IST_STACK_SIZE);
+    g_tss.ist[IST_PAGE_FAULT - 1]   = (uint64_t)(g_ist_pf_stack + IST_STACK_SIZE);
+    g_tss.iomap_base = sizeof(struct tss64);   // I/O bitmap yok
+
+    uint64_t base  = (uint64_t)&g_tss;
+    uint64_t limit = sizeof(struct tss64) - 1;
+    g_gdt[3] = (limit & 0xFFFF) |
+               ((base & 0xFFFFFF) << 16) |
+               (0x89ULL << 40) |                 // P, 64-bit available TSS
+               (((limit >> 16) & 0xF) << 48) |
+               (((base >> 24) & 0xFF) << 56);
+    g_gdt[4] = base >> 32;
+
+    struct {
+        uint16_t limit;
+        uint64_t base;
+    } __attribute__((packed)) GDTR = { sizeof(g_gdt) - 1, (uint64_t)g_gdt };
+
+    // CS far return ile, veri segmentleri doğrudan yeniden yüklenir
+    __asm__ volatile(
+        "lgdt %0\n\t"
+        "mov %1, %%ds\n\t"
+        "mov %1, %%es\n\t"
+        "mov %1, %%ss\n\t"
+        "mov %1, %%fs\n\t"
+        "mov %1, %%gs\n\t"
+        "pushq %2\n\t"
+        "lea 1f(%%rip), %%rax\n\t"
+        "pushq %%rax\n\t"
+        "lretq\n"
+        "1:\n\t"
+        "ltr %w3"
+        :
+        : "m"(GDTR), "r"((uint64_t)GDT_KERNEL_DATA),
+          "i"(GDT_KERNEL_CODE), "r"((uint64_t)GDT_TSS)
+        : "rax", "memory");
 }
 
 void idt_init(void)
@@ -1,5 +1,16 @@
 #pragma once
 
+// Kernel GDT seçicileri (gdt_init sonrası)
+#define GDT_KERNEL_CODE   0x08
+#define GDT_KERNEL_DATA   0x10
+#define GDT_TSS           0x18
+
+// TSS Interrupt Stack Table indeksleri (1..7; 0 = IST yok).
+// Taşmış ya da map'siz bir stack'te oluşan hatalar kendi stack'lerinde
+// çalışır; aksi halde frame push edilemez ve CPU triple fault'a gider.
+#define IST_DOUBLE_FAULT  1
+#define IST_PAGE_FAULT    2
+
 void gdt_init(void);
 void idt_init(void);
 void isr_init_stubs(void);
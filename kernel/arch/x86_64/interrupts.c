@@ -1,6 +1,13 @@
 #include <stdint.h>
 #include "interrupts.h"
 #include "gdt_idt.h"
+#include "../../include/mm.h"
+#include "../../include/proc.h"
+#include "../../sched/sched.h"
+#include "../../drivers/console/fb_console.h"
+
+#define DOUBLE_FAULT_VECTOR 8
+#define PAGE_FAULT_VECTOR 14
 
 struct idt_entry {
     uint16_t offset_low;
@@ -21,17 +28,80 @@ struct idt_entry idt_table[256];
 struct idt_ptr idt_descriptor;
 
 void idt_set_gate(int num, interrupt_handler_t handler, uint8_t flags)
+{
+    idt_set_gate_ist(num, handler, flags, 0);
+}
+
+void idt_set_gate_ist(int num, interrupt_handler_t handler, uint8_t flags, uint8_t ist)
 {
     uint64_t addr = (uint64_t)handler;
     idt_table[num].offset_low = addr & 0xFFFF;
-    idt_table[num].selector = 0x08; // kernel code segment
-    idt_table[num].ist = 0;
+    idt_table[num].selector = GDT_KERNEL_CODE;
+    idt_table[num].ist = ist;
     idt_table[num].type_attr = flags;
     idt_table[num].offset_mid = (addr >> 16) & 0xFFFF;
     idt_table[num].offset_high = (addr >> 32) & 0xFFFFFFFF;
     idt_table[num].zero = 0;
 }
 
+// #PF: user bölgelerinde demand paging; çözülemezse user process
+// sonlandırılır, kernel hatasında sistem durur. Interrupt gate'te IF=0:
+// sched_exit_current geri dönmeden başka bir process'e (ya da idle'a) geçer.
+//
+// Kendi IST stack'inde çalışır: user kodu CPL0'da kendi stack'iyle
+// koştuğundan stack büyümesi ve COW stack sayfaları #PF'yi tam da frame'in
+// push edileceği sayfada üretir. IST her girişte en tepeden başladığı için
+// handler uyumamalı (yield/block yok) ve kendi içinde #PF almamalıdır;
+// sched_exit_current ile bırakılan frame bir daha devam ettirilmez.
+__attribute__((interrupt))
+static void page_fault_isr(struct interrupt_frame *frame, uint64_t error_code)
+{
+    uint64_t addr;
+    __asm__ volatile("mov %%cr2, %0" : "=r"(addr));
+
+    if (vm_page_fault(addr, error_code) == 0)
+        return;
+
+    fb_print("[#PF] unhandled fault addr=");
+    fb_print_hex(addr);
+    fb_print(" rip=");
+    fb_print_hex(frame->rip);
+    fb_print(" err=");
+    fb_print_hex(error_code);
+    fb_print("\n");
+
+    if (current_proc && current_proc->type == PROC_TYPE_USER) {
+        fb_print("[#PF] killing process ");
+        fb_print(current_proc->name);
+        fb_print("\n");
+        sched_exit_current();
+    }
+
+    for (;;)
+        __asm__ volatile("cli; hlt");
+}
+
+// #DF: genellikle bir hatanın frame'i push edilemediğinde (taşmış ya da
+// map'siz stack) oluşur. Kendi IST stack'inde çalışır; tanı basıp durur.
+__attribute__((interrupt))
+static void double_fault_isr(struct interrupt_frame *frame, uint64_t error_code)
+{
+    (void)error_code;
+
+    fb_print("[#DF] double fault rip=");
+    fb_print_hex(frame->rip);
+    fb_print(" rsp=");
+    fb_print_hex(frame->rsp);
+    if (current_proc) {
+        fb_print(" proc=");
+        fb_print(current_proc->name);
+    }
+    fb_print("\n");
+
+    for (;;)
+        __asm__ volatile("cli; hlt");
+}
+
 void interrupts_install(void)
 {
     // zero-out IDT
@@ -49,4 +119,9 @@ void interrupts_install(void)
     idt_descriptor.base = (uint64_t)&idt_table[0];
 
     idt_init();
+
+    idt_set_gate_ist(DOUBLE_FAULT_VECTOR, (interrupt_handler_t)(void *)double_fault_isr,
+                     0x8E, IST_DOUBLE_FAULT);
+    idt_set_gate_ist(PAGE_FAULT_VECTOR, (interrupt_handler_t)(void *)page_fault_isr,
+                     0x8E, IST_PAGE_FAULT);
 }
@@ -12,4 +12,6 @@ struct interrupt_frame {
 typedef void (*interrupt_handler_t)(struct interrupt_frame *frame);
 
 void idt_set_gate(int num, interrupt_handler_t handler, uint8_t flags);
+// ist: TSS IST indeksi (1..7), 0 = kesilen kodun stack'i
+void idt_set_gate_ist(int num, interrupt_handler_t handler, uint8_t flags, uint8_t ist);
 void interrupts_install(void);
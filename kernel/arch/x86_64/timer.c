@@ -15,8 +15,11 @@ static void timer_isr(struct interrupt_frame *frame)
 {
     (void)frame;
     tick_count++;
-    sched_yield();
+
+    // EOI geçişten önce: yeni process bu ISR'dan dönmeden çalışır ve
+    // (idle dahil) hlt'de bir sonraki tick'i bekleyebilir.
     pic_send_eoi(0);
+    sched_yield();
 }
 
 void timer_init(uint32_t frequency_hz)
@@ -1,6 +1,7 @@
 // kernel/drivers/console/fb_console.c
 #include "fb_console.h"
 #include "font8x16.h"
+#include "../../include/mm.h"
 #include <stddef.h>
 
 // Framebuffer bilgileri
@@ -9,6 +10,7 @@ static uint32_t fb_width  = 0;
 static uint32_t fb_height = 0;
 static uint32_t fb_pitch  = 0;
 static uint32_t fb_bpp    = 0;
+static uint64_t fb_phys   = 0;
 
 // Font
 #define FONT_W 8
@@ -290,7 +292,9 @@ void fb_console_init(ayken_boot_info_t *boot)
 {
     // Fiziksel framebuffer adresini higher-half'a map ettiğini varsayıyorum.
     // Daha güzel hal: phys_to_virt(boot->fb_phys_addr)
+    // paging_init sonrası fb_console_remap_wc ile KIO penceresine taşınır.
     fb = (uint8_t*)(boot->fb_phys_addr + 0xFFFFFFFF80000000ULL);
+    fb_phys = boot->fb_phys_addr;
 
     fb_width  = boot->fb_width;
     fb_height = boot->fb_height;
@@ -309,6 +313,20 @@ void fb_console_init(ayken_boot_info_t *boot)
     cursor_x = cursor_y = 0;
 }
 
+// Framebuffer'ı write-combining olarak yeniden map et (PAT, paging_init
+// sonrası). Piksel yazmaları tek tek uncached store yerine WC tamponlarında
+// birleşir. Eski boot penceresi alias'ı bundan sonra kullanılmaz.
+void fb_console_remap_wc(void)
+{
+    if (!fb || !fb_phys)
+        return;
+
+    uint8_t *wc = (uint8_t *)paging_map_io(fb_phys, (uint64_t)fb_pitch * fb_height,
+                                          PAGING_CACHE_WC);
+    if (wc)
+        fb = wc;
+}
+
 // Mini-log bölgesi için text alanını sağ alt köşeye taşı
 void fb_set_text_region(uint32_t cols, uint32_t rows)
 {
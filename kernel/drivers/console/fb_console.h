@@ -26,6 +26,7 @@ typedef enum {
 
 // Temel fonksiyonlar
 void fb_console_init(ayken_boot_info_t *boot);
+void fb_console_remap_wc(void);
 void fb_set_text_region(uint32_t cols, uint32_t rows);
 void fb_clear(void);
 
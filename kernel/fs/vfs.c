@@ -6,6 +6,7 @@
 #include <stdbool.h>
 
 #include "../include/fs.h"
+#include "../include/mm.h"
 #include "../ai/ayken_core_lm_format.h"
 
 #define TAR_BLOCK_SIZE 512
@@ -48,10 +49,13 @@ static vfs_node_t  g_ramfs_nodes[VFS_MAX_FILES];
 static uint32_t    g_ramfs_count = 0;
 static vfs_file_t  g_open_files[VFS_MAX_OPEN];
 
-static uint8_t     g_initrd_tar[2048];
-static uint64_t    g_initrd_tar_size = 0;
+// initrd imajı boot arena'sında: vfs ömrü boyunca yaşar, tek tek free yok
+#define VFS_DUMMY_MODEL_MAX  256
+#define VFS_INITRD_MAX       (TAR_BLOCK_SIZE + VFS_DUMMY_MODEL_MAX + TAR_BLOCK_SIZE * 2)
 
-static uint8_t     g_dummy_model[256];
+static arena_t     g_vfs_arena;
+static uint8_t    *g_initrd_tar = NULL;
+static uint64_t    g_initrd_tar_size = 0;
 
 static void vfs_memset(void *dst, int value, uint64_t size)
 {
@@ -188,9 +192,18 @@ static uint64_t build_dummy_model(uint8_t *buffer, uint64_t buffer_size)
 
 static void build_initrd_tar(void)
 {
-    uint64_t model_size = build_dummy_model(g_dummy_model, sizeof(g_dummy_model));
+    g_initrd_tar_size = 0;
+
+    g_initrd_tar = (uint8_t*)arena_alloc(&g_vfs_arena, VFS_INITRD_MAX, TAR_BLOCK_SIZE);
+    if (!g_initrd_tar) {
+        return;
+    }
+    vfs_memset(g_initrd_tar, 0, VFS_INITRD_MAX);
+
+    // Model doğrudan tar'ın veri bloğuna yazılır (ara buffer + kopya yok)
+    uint8_t *model = g_initrd_tar + TAR_BLOCK_SIZE;
+    uint64_t model_size = build_dummy_model(model, VFS_DUMMY_MODEL_MAX);
     if (model_size == 0) {
-        g_initrd_tar_size = 0;
         return;
     }
 
@@ -221,17 +234,13 @@ static void build_initrd_tar(void)
 
     tar_fill_checksum(&hdr);
 
-    vfs_memset(g_initrd_tar, 0, sizeof(g_initrd_tar));
     vfs_memcpy(g_initrd_tar, &hdr, sizeof(hdr));
 
-    uint64_t copy_size = model_size;
-    vfs_memcpy(g_initrd_tar + TAR_BLOCK_SIZE, g_dummy_model, copy_size);
-
-    uint64_t aligned_data = ((copy_size + TAR_BLOCK_SIZE - 1) / TAR_BLOCK_SIZE) * TAR_BLOCK_SIZE;
+    uint64_t aligned_data = ((model_size + TAR_BLOCK_SIZE - 1) / TAR_BLOCK_SIZE) * TAR_BLOCK_SIZE;
     g_initrd_tar_size = TAR_BLOCK_SIZE + aligned_data + (TAR_BLOCK_SIZE * 2);
 
-    if (g_initrd_tar_size > sizeof(g_initrd_tar)) {
-        g_initrd_tar_size = sizeof(g_initrd_tar);
+    if (g_initrd_tar_size > VFS_INITRD_MAX) {
+        g_initrd_tar_size = VFS_INITRD_MAX;
     }
 }
 
@@ -277,6 +286,13 @@ void vfs_init(void)
         g_open_files[i].offset = 0;
     }
 
+    // Yeniden init: eski initrd imajı topluca geri alınır
+    if (g_vfs_arena.head) {
+        arena_reset(&g_vfs_arena);
+    } else if (arena_init(&g_vfs_arena, VFS_INITRD_MAX) != 0) {
+        return;
+    }
+
     build_initrd_tar();
 
     if (g_initrd_tar_size > 0) {
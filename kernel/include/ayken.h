@@ -6,8 +6,38 @@
 // Higher half base for kernel virtual addresses
 #define KERNEL_VIRT_BASE 0xFFFFFFFF80000000ULL
 
+// SMP üst sınırı (per-CPU tablolar bu boyutta tutulur)
+#define AYKEN_MAX_CPUS   16
+
+// Idle thread'in önceden sıfırladığı frame havuzu (0 → devre dışı)
+#ifndef AYKEN_ZERO_POOL_FRAMES
+#define AYKEN_ZERO_POOL_FRAMES   256
+#endif
+
+// Allocator telemetrisi (çağrı yeri sayaçları, boyut histogramı).
+// 0 iken hook'lar boş makroya açılır; -DAYKEN_MM_STATS=1 ile derleyin.
+#ifndef AYKEN_MM_STATS
+#define AYKEN_MM_STATS           0
+#endif
+
+// Frame allocator tutarlılık kontrolleri (double free → magazine taraması).
+// Her phys_free_frame tüm magazine'leri gezer; yalnızca hata ayıklarken.
+#ifndef AYKEN_PHYS_DEBUG
+#define AYKEN_PHYS_DEBUG         0
+#endif
+
+// Boot self-test: init bir user process'i COW ile klonlar, iki tarafı da
+// çalıştırıp çıkış kodlarını kontrol eder.
+#ifndef AYKEN_CLONE_SELFTEST
+#define AYKEN_CLONE_SELFTEST     1
+#endif
+
 // Default user address space layout helpers
 #define USER_TEXT_BASE   0x0000000000400000ULL
 #define USER_STACK_TOP   0x0000000000800000ULL
+#define USER_STACK_MAX   0x0000000000100000ULL   // stack'in büyüyebileceği en fazla
+#define USER_SPACE_END   0x0000800000000000ULL   // kanonik alt yarının sonu
+#define USER_MMAP_BASE   0x0000100000000000ULL   // vm_mmap bölgeleri
+#define USER_MMAP_END    0x0000700000000000ULL
 
 #endif // AYKEN_KERNEL_LIMITS_H
@@ -12,9 +12,10 @@
 // 4KB frame standardı
 #define AYKEN_FRAME_SIZE            4096ULL
 
-// İleride 128GB RAM’e kadar çıkabilir; fakat şimdilik OS için 4GB sınır yeterli.
-#define AYKEN_MAX_PHYS_MEM          (4ULL * 1024ULL * 1024ULL * 1024ULL)
-#define AYKEN_MAX_FRAMES            (AYKEN_MAX_PHYS_MEM / AYKEN_FRAME_SIZE)
+// Sabit bir fiziksel bellek sınırı yok: frame veritabanı EFI memory map'e
+// göre boyutlandırılır. Adres alanı 2^AYKEN_PHYS_SECTION_SHIFT (128 MiB)
+// boyutlu section'lara bölünür; RAM içermeyen section'lar metadata tutmaz.
+#define AYKEN_PHYS_SECTION_SHIFT    27
 
 // Page table entry flag bits (x86_64)
 #define AYKEN_PTE_PRESENT         (1ULL << 0)
@@ -23,6 +24,10 @@
 #define AYKEN_PTE_GLOBAL          (1ULL << 8)
 #define AYKEN_PTE_ADDR_MASK       0x000FFFFFFFFFF000ULL
 
+// Büyük sayfa boyutları (PDE.PS / PDPTE.PS)
+#define AYKEN_PAGE_SIZE_2M        (2ULL * 1024ULL * 1024ULL)
+#define AYKEN_PAGE_SIZE_1G        (1024ULL * 1024ULL * 1024ULL)
+
 
 // -----------------------------------------------------------------------------
 // FİZİKSEL BELLEK BAŞLATMA
@@ -30,7 +35,8 @@
 
 /**
  * EFI memory map üzerinden kullanılabilir fiziksel RAM’i analiz eder.
- * Frame bitmap/tablosunu oluşturur.
+ * Frame bitmap/tablosunu oluşturur; tablo usable RAM'in içinden kesilir
+ * ve kurulu RAM miktarına göre boyutlanır.
  *
  * @param efi_mem_map        EFI tarafından verilen memory map pointer'ı
  * @param desc_size          Her memory descriptor'ın boyutu
@@ -44,6 +50,19 @@ void phys_mem_init(void *efi_mem_map,
                    uint64_t kernel_phys_start,
                    uint64_t kernel_phys_end);
 
+/**
+ * Bu fiziksel adresten itibaren frame verilmez. phys_mem_init sınırı boot
+ * penceresinin sonuna (2 GiB) koyar; paging direct map kurulunca kaldırır.
+ */
+void phys_mem_set_alloc_limit(uint64_t phys_end);
+
+/**
+ * phys_mem_init'te kaydedilen RAM aralıklarını (usable + reclaimable,
+ * bitişikler birleştirilmiş) [start, end) olarak gezer. Direct map kurulumu.
+ */
+void phys_mem_for_each_ram_range(void (*fn)(uint64_t start, uint64_t end, void *ctx),
+                                 void *ctx);
+
 
 // -----------------------------------------------------------------------------
 // FRAME ALLOKASYONU
@@ -56,10 +75,54 @@ void phys_mem_init(void *efi_mem_map,
 uint64_t phys_alloc_frame(void);
 
 /**
- * Ayrılmış bir frame’i boşaltır.
+ * phys_alloc_frame / phys_alloc_frames'in telemetri çağrı yerini açıkça
+ * alan hâlleri. Frame'i başkası adına ayıran sarmalayıcılar (sıfır havuzu,
+ * paging_map_anon, ...) kendi çağıranlarını (MM_STATS_CALLER) geçirir;
+ * böylece rapor allocator iç fonksiyonlarını değil sahibi gösterir.
+ */
+uint64_t phys_alloc_frame_at(void *site);
+uint64_t phys_alloc_frames_at(uint64_t count, void *site);
+
+/**
+ * Ayrılmış bir frame’i boşaltır. Zaten boş frame yok sayılır; henüz
+ * per-CPU magazine'de duran bir frame'in ikinci free'si ise yalnızca
+ * AYKEN_PHYS_DEBUG ile yakalanır.
  */
 void phys_free_frame(uint64_t phys_addr);
 
+/**
+ * Frame'e bir sahip daha ekler (COW paylaşımı). Sonraki her
+ * phys_free_frame bir sahibi düşürür; frame son sahiple boşalır.
+ * Frame ayrılmış değilse ya da sayaç doluysa -1 (çağıran kopyalamalı).
+ */
+int      phys_frame_ref(uint64_t phys_addr);
+
+/** Frame'in sahip sayısı (ayrılmış değilse 0). */
+uint32_t phys_frame_refcount(uint64_t phys_addr);
+
+/**
+ * Frame başına 16 bitlik sahip alanı (paging: tablo doluluk sayacı).
+ * Section yoksa NULL. Sahip, frame'i boşaltırken 0'da bırakmalıdır.
+ */
+uint16_t *phys_frame_aux(uint64_t phys_addr);
+
+/**
+ * İçeriği sıfırlanmış bir frame ayırır (page table, user image/stack).
+ * Önce idle thread'in doldurduğu sıfır havuzundan verilir; havuz boşsa
+ * frame ayrılıp senkron sıfırlanır. (mm/page_zero.c)
+ * @return fiziksel adres (başarısız olursa 0)
+ */
+uint64_t phys_alloc_zeroed_frame(void);
+
+/**
+ * Sıfır havuzunu dolduran idle öncelikli thread gövdesi; geri dönmez.
+ * proc_create_idle_thread() ile başlatılır.
+ */
+void     phys_zero_pool_worker(void);
+
+/** Havuzda bekleyen sıfırlanmış frame sayısı. */
+uint64_t phys_zero_pool_count(void);
+
 
 // -----------------------------------------------------------------------------
 // PAGING (Sanal Bellek) Yönetimi – paging.c API
@@ -67,9 +130,26 @@ void phys_free_frame(uint64_t phys_addr);
 //
 //  Not:
 //    paging_init() → phys_mem_init() tamamlandıktan sonra çağrılmalıdır.
-//    Çünkü page table belleklerini phys_alloc_frame() ile ayırıyoruz.
+//    Çünkü page table belleklerini phys_alloc_zeroed_frame() ile ayırıyoruz.
+//
+//  Direct map: paging_init tüm RAM'i (EFI map'teki usable + reclaimable
+//  aralıklar) DIRECT_MAP_BASE + phys adresine 1GB/2MB sayfalarla map eder
+//  (PML4[256..319]). Kurulana kadar paging_phys_to_virt bootloader'ın
+//  higher-half penceresini (phys + KERNEL_VIRT_BASE, ilk 2 GiB) kullanır.
+//  32 TiB'ın üstündeki RAM map edilmez ve frame allocator'a verilmez.
+//
+//  Kernel yarısının yerleşimi:
+//    PML4[256..319]  direct map (DIRECT_MAP_BASE, 32 TiB)
+//    PML4[320]       AykenCoreLM model penceresi (CORE_LM_WINDOW_BASE)
+//    PML4[510]       kernel heap / slab / stack / MMIO (KHEAP_WINDOW_BASE)
+//    PML4[511]       kernel imajı (KERNEL_VIRT_BASE)
 // -----------------------------------------------------------------------------
 
+#define DIRECT_MAP_BASE      0xFFFF800000000000ULL                // PML4[256]
+#define DIRECT_MAP_SIZE      (32ULL * 1024ULL * 1024ULL * 1024ULL * 1024ULL) // 32 TiB
+
+#define CORE_LM_WINDOW_BASE  0xFFFFA00000000000ULL                // PML4[320]
+
 /**
  * Bootloader tarafından verilen PML4 fiziksel adresini devralır,
  * CR3'e yükler ve kernel'in page table kökünü ayarlar.
@@ -81,12 +161,39 @@ void     paging_init(uint64_t boot_pml4_phys);
  */
 void     paging_load_cr3(uint64_t phys_addr);
 
+/**
+ * Adres alanına geçiş için CR3 değeri. CPU PCID destekliyorsa her adres
+ * alanı nesil tabanlı bir PCID alır ve değer no-flush biti taşır; TLB
+ * girişleri geçişler arasında korunur. PCID'ler tükenince nesil artar,
+ * TLB bir kez tamamen temizlenir ve herkes yeni PCID alır.
+ * pcid/gen çağıranın (proc_t) saklamasıdır; gen == 0 atanmamış demektir.
+ * Kernel PML4 her zaman PCID 0'dır. Destek yoksa yalnızca pml4_phys döner.
+ *
+ * Not: Yüklü olmayan bir adres alanından map kaldırılırsa (*gen = 0)
+ * yapılmalıdır; invlpg yalnızca aktif PCID'yi (ve global girişleri) siler.
+ */
+uint64_t paging_asid_cr3(uint64_t pml4_phys, uint16_t *pcid, uint32_t *gen);
+
 /** Kernel PML4 fiziksel kök adresi. */
 uint64_t paging_get_kernel_pml4_phys(void);
 
+/**
+ * Alt limit_phys bölgesinin identity mapping'ini kaldırır: tamamen
+ * kapsanan PML4/PDPT/PD girişleri tek seferde silinir, boşalan tablolar
+ * frame allocator'a döner (kernel yarısıyla paylaşılanlar hariç),
+ * sonda tek TLB flush.
+ */
+void     paging_drop_identity_map(uint64_t limit_phys);
+
 /** Yeni bir kullanıcı alanı PML4'ü oluşturur ve kernel yarım alanını kopyalar. */
 uint64_t paging_create_user_pml4(void);
 
+/**
+ * paging_create_user_pml4 ile oluşturulmuş kökü geri verir. User yarısı
+ * önceden boşaltılmış (vm_space_destroy) ve PML4 yüklü olmamalıdır.
+ */
+void     paging_destroy_user_pml4(uint64_t pml4_phys);
+
 /**
  * Yeni bir 4KB page table (PML4/PDPT/PD/PT) ayırır ve sıfırlar.
  * @return fiziksel adres (başarısız olursa 0)
@@ -107,6 +214,130 @@ void     paging_map_page_in_pml4(uint64_t pml4_phys,
                                  uint64_t phys_addr,
                                  uint64_t flags);
 
+/**
+ * Tek bir büyük sayfa map eder (page_size: AYKEN_PAGE_SIZE_2M/1G).
+ * virt/phys hizasız, CPU 1GB desteklemiyor ya da slotta zaten 4KB
+ * tablosu varsa -1 döner (çağıran 4KB'a düşmeli).
+ */
+int      paging_map_huge(uint64_t virt_addr, uint64_t phys_addr,
+                         uint64_t page_size, uint64_t flags);
+
+/**
+ * Fiziksel olarak ardışık bir bölgeyi map eder; hizalama ve boyut izin
+ * verdikçe 1GB/2MB sayfa, gerisi 4KB.
+ */
+void     paging_map_region(uint64_t virt_addr, uint64_t phys_addr,
+                           uint64_t size, uint64_t flags);
+
+/**
+ * Bellek tipleri. Değer, paging_init'in programladığı PAT indeksidir
+ * (PTE'de PWT = bit 0, PCD = bit 1, PAT = bit 2). İlk dördü power-on
+ * varsayılanlarıyla aynı; PA4 write-combining'e ayrılır.
+ */
+typedef enum {
+    PAGING_CACHE_WB       = 0,
+    PAGING_CACHE_WT       = 1,
+    PAGING_CACHE_UC_MINUS = 2,
+    PAGING_CACHE_UC       = 3,
+    PAGING_CACHE_WC       = 4,
+} paging_cache_t;
+
+/**
+ * Bir MMIO bölgesini (framebuffer, aygıt BAR'ı) KIO penceresine verilen
+ * bellek tipiyle map eder; mümkünse 2MB sayfalarla. phys hizasız
+ * olabilir, dönen pointer aynı ofseti taşır. Pencere doluysa NULL.
+ * Map'ler kalıcıdır (pencere yalnızca ileri doğru tüketilir).
+ */
+void    *paging_map_io(uint64_t phys, uint64_t size, paging_cache_t type);
+
+/**
+ * virt'teki page_size'lık büyük sayfayı kaldırır; fiziksel tabanı döner.
+ * O adreste o boyutta büyük sayfa yoksa 0 (hiçbir şey değişmez).
+ */
+uint64_t paging_unmap_huge(uint64_t virt, uint64_t page_size);
+
+/**
+ * count adet (ardışık olması gerekmeyen) 4KB frame'i virt'ten itibaren
+ * map eder; tablolar PT başına bir kez yürünür, TLB tek seferde flush
+ * edilir. Tablo ayrılamazsa -1 (o ana kadarki girişler map'li kalır).
+ */
+int      paging_map_range(uint64_t virt, const uint64_t *frames,
+                          uint64_t count, uint64_t flags);
+
+/** paging_map_range'in henüz yüklenmemiş bir PML4 için olanı (flush yok). */
+int      paging_map_range_in_pml4(uint64_t pml4_phys, uint64_t virt,
+                                  const uint64_t *frames, uint64_t count,
+                                  uint64_t flags);
+
+/**
+ * [virt, virt+size) aralığındaki tüm map'leri (büyük sayfalar dahil)
+ * kaldırır; kısmen kapsanan büyük sayfalar bölünür. free_frames != 0 ise
+ * frame'ler allocator'a geri verilir. TLB gather ile tek flush.
+ */
+void     paging_unmap_range(uint64_t virt, uint64_t size, int free_frames);
+
+/**
+ * paging_unmap_range'in verilen PML4 için olanı. PML4 yüklü değilse flush
+ * yok; yüklüyse geçerli PCID'de geçersizlenir.
+ * @return kaldırılan map'lerin 4KB sayfa karşılığı
+ */
+uint64_t paging_unmap_range_in_pml4(uint64_t pml4_phys, uint64_t virt,
+                                    uint64_t size, int free_frames);
+
+/**
+ * Copy-on-write: src PML4'teki [virt, virt+size) 4KB map'lerini dst'ye
+ * aynı frame'lerle kurar; yazılabilir sayfalar iki tarafta salt okunur
+ * + COW işaretli olur. src yüklü değilse çağıran onun PCID'sini
+ * geçersizlemelidir (bkz. paging_asid_cr3). Başarısızlıkta -1.
+ */
+int      paging_cow_share(uint64_t src_pml4_phys, uint64_t dst_pml4_phys,
+                          uint64_t virt, uint64_t size);
+
+/**
+ * paging_cow_share'in paylaşımsız hali: src'deki map'li 4KB sayfaların
+ * dst'de hemen özel, yazılabilir kopyası kurulur; src değişmez (flush
+ * yok). Yazma #PF'inin tehlikeli olduğu sayfalar (çalışan stack) için.
+ * Başarısızlıkta -1.
+ */
+int      paging_copy_range(uint64_t src_pml4_phys, uint64_t dst_pml4_phys,
+                           uint64_t virt, uint64_t size);
+
+/**
+ * COW işaretli sayfaya yazma #PF'i: frame paylaşılıyorsa özel kopya
+ * alınır, değilse yazma izni geri verilir. pml4 yüklü olmalıdır.
+ * COW sayfası değilse ya da bellek yoksa -1.
+ */
+int      paging_cow_break(uint64_t pml4_phys, uint64_t virt);
+
+/**
+ * phys'i virt'e salt okunur map eder; flags yazılabilirse giriş COW
+ * işaretlenir ve ilk yazma paging_cow_break'e düşer. Frame'in sahipliği
+ * (phys_frame_ref) çağırana aittir; paging_zero_frame() için gerekmez.
+ * Yüklü olmayan bir adres alanında ya da boş bir girişe kurulmalıdır
+ * (flush yok). Tablo ayrılamazsa -1.
+ */
+int      paging_map_cow_in_pml4(uint64_t pml4_phys, uint64_t virt,
+                                uint64_t phys, uint64_t flags);
+
+/**
+ * Tüm adres alanlarının paylaştığı kalıcı sıfır frame'i (ilk çağrıda
+ * ayrılır; 0 → bellek yok). Referans sayılmaz: unmap onu geri vermez,
+ * paging_cow_share sayacına dokunmaz, paging_cow_break hep kopyalar.
+ */
+uint64_t paging_zero_frame(void);
+
+/**
+ * [virt, virt+size) için frame ayırıp map eder (mümkünse 2MB sayfa).
+ * Başarısızlıkta -1 ve aralık tamamen geri alınmış olur.
+ */
+int      paging_map_anon(uint64_t virt, uint64_t size, uint64_t flags);
+
+/**
+ * Kernel yarısındaki virt için PML4 girişini önceden oluşturur; sonradan
+ * lazy map edilen bölgelerin tüm user PML4'lerde görünmesini sağlar.
+ */
+void     paging_reserve_kernel_slot(uint64_t virt);
+
 /**
  * Eski API ile uyumluluk: paging_map() → paging_map_page() çağırır.
  */
@@ -114,18 +345,258 @@ void     paging_map(uint64_t virt, uint64_t phys, uint64_t flags);
 
 /**
  * Bir sanal adresin map'ini kaldırır (PT entry = 0) ve TLB flush eder.
+ * Adres büyük bir sayfanın içindeyse sayfa önce 4KB'lara bölünür.
  */
 void     paging_unmap(uint64_t virt);
 
 /**
- * Bir sanal adresin hangi fiziksel adresle eşleştiğini döndürür.
- * Bulunamazsa 0 döndürür.
+ * Bir sanal adresin hangi fiziksel (4KB) frame ile eşleştiğini döndürür;
+ * büyük sayfalarda virt'i içeren 4KB frame. Bulunamazsa 0 döndürür.
  */
 uint64_t paging_get_phys(uint64_t virt);
 
-/** Fiziksel adresi kernel sanal alanına çevirir (higher-half mapping). */
+/** Fiziksel adresi kernel sanal alanına çevirir (direct map). */
 void    *paging_phys_to_virt(uint64_t phys);
 
+/**
+ * PML4 hiyerarşisindeki tüm page table frame'lerini (kök dahil) gezer.
+ * Huge sayfa girişlerinin altına inilmez.
+ */
+void     paging_for_each_table_frame(uint64_t pml4_phys,
+                                     void (*fn)(uint64_t phys, void *ctx),
+                                     void *ctx);
+
+
+// -----------------------------------------------------------------------------
+// BOOT BELLEĞİ GERİ KAZANIMI
+// -----------------------------------------------------------------------------
+
+/**
+ * EfiBootServicesCode/Data ve EfiLoaderCode/Data bölgelerini allocator'a
+ * geri verir (canlı page table'lar ve GDT korunur).
+ * boot_info ve memory map'e artık ihtiyaç kalmadığında, boot stack'i
+ * dışında bir kez çağrılmalıdır.
+ *
+ * @return geri kazanılan frame sayısı
+ */
+uint64_t phys_mem_reclaim_boot_memory(void);
+
+/** Frame henüz geri kazanılmamış bir boot bölgesindeyse 1. */
+int      phys_mem_is_reclaimable(uint64_t phys_addr);
+
+
+// -----------------------------------------------------------------------------
+// KERNEL HEAP (kmalloc / kfree) – kheap.c + slab.c
+// -----------------------------------------------------------------------------
+//
+//  Sanal pencere: PML4[510] kernel heap'e ayrılmış (higher-half kernel /
+//  phys_to_virt penceresiyle çakışmaz). Sayfalar talep geldikçe map edilir.
+//    [KSLAB_START, +KSLAB_WINDOW_SIZE)  küçük object slab'ları (≤ KSLAB_MAX_SIZE)
+//    [KHEAP_START, +KHEAP_WINDOW_SIZE)  büyük istekler için blok heap'i;
+//                                        KHEAP_GROW_CHUNK adımlarla büyür/küçülür
+//    [KSTACK_START, +KSTACK_WINDOW_SIZE) guard sayfalı kernel stack slot'ları
+//    [KIO_START, +KIO_WINDOW_SIZE)       MMIO map'leri (paging_map_io)
+// -----------------------------------------------------------------------------
+
+#define KHEAP_WINDOW_BASE    0xFFFFFF0000000000ULL                // PML4[510]
+
+#define KSLAB_START          KHEAP_WINDOW_BASE
+#define KSLAB_WINDOW_SIZE    (256ULL * 1024ULL * 1024ULL)
+#define KSLAB_SIZE           (32ULL * 1024ULL)                    // slab = 8 sayfa
+#define KSLAB_MAX_SIZE       4096ULL
+
+#define KHEAP_START          (KSLAB_START + KSLAB_WINDOW_SIZE)
+#define KHEAP_WINDOW_SIZE    (16ULL * 1024ULL * 1024ULL * 1024ULL) // 16 GiB rezerve
+#define KHEAP_INITIAL_SIZE   (1ULL * 1024ULL * 1024ULL)           // boot'ta map edilen
+#define KHEAP_GROW_CHUNK     (256ULL * 1024ULL)
+
+#define KSTACK_START         (KHEAP_START + KHEAP_WINDOW_SIZE)
+#define KSTACK_WINDOW_SIZE   (256ULL * 1024ULL * 1024ULL)
+#define KSTACK_SIZE          (16ULL * 1024ULL)                    // map'li stack
+#define KSTACK_GUARD_SIZE    (16ULL * 1024ULL)                    // altında map'siz guard
+
+#define KIO_START            (KSTACK_START + KSTACK_WINDOW_SIZE)  // paging_map_io
+#define KIO_WINDOW_SIZE      (64ULL * 1024ULL * 1024ULL * 1024ULL)
+
+void  kheap_init(void);
+
+/**
+ * size ≤ KSLAB_MAX_SIZE → slab boyut sınıfı (O(1)),
+ * daha büyükleri sayfa katına yuvarlanıp blok heap'ten verilir.
+ */
+void *kmalloc(uint64_t size);
+void  kfree(void *ptr);
+
+/** Slab katmanı (kmalloc içinden kullanılır). */
+void  kslab_init(void);
+void *kslab_alloc(uint64_t size);
+void  kslab_free(void *ptr);
+int   kslab_owns(const void *ptr);
+
+/**
+ * Tipli object cache'leri (slab.c). Sık ayrılan sabit boyutlu object'ler
+ * için: object'ler en az 64 byte'a hizalı, per-CPU magazine'lerde sıcak.
+ * ctor (NULL olabilir) object slab'dan çıkarken çalışır; kmem_cache_free'ye
+ * verilen object inşa edilmiş halde (ctor sonrası durum) olmalıdır.
+ */
+typedef struct kslab_class kmem_cache_t;
+
+typedef struct {
+    const char *name;
+    uint64_t obj_size;
+    uint64_t per_slab;
+    uint64_t slabs;
+    uint64_t active;     // kullanıcıda olan object
+    uint64_t cached;     // magazine'lerde bekleyen object
+    uint64_t allocs;     // magazine üzerinden alloc/free sayısı
+    uint64_t frees;
+    uint64_t refills;    // depot'a inilen sayı
+    uint64_t flushes;
+} kmem_cache_stats_t;
+
+kmem_cache_t *kmem_cache_create(const char *name, uint64_t size,
+                                uint64_t align, void (*ctor)(void *obj));
+void *kmem_cache_alloc(kmem_cache_t *cache);
+void  kmem_cache_free(kmem_cache_t *cache, void *obj);
+void  kmem_cache_get_stats(kmem_cache_t *cache, kmem_cache_stats_t *out);
+
+/**
+ * Kernel stack'leri (kstack.c): KSTACK_SIZE, sayfa hizalı, altında guard.
+ * kstack_alloc stack'in tepesini (ilk rsp) döner, 0 → bellek yok.
+ */
+uint64_t kstack_alloc(void);
+void     kstack_free(uint64_t top);
+
+
+// -----------------------------------------------------------------------------
+// ARENA (arena.c)
+// -----------------------------------------------------------------------------
+//
+//  Birlikte ölen veriler için bump allocator: boot/initrd tabloları ve
+//  istek başına scratch bellek. Frame chunk'larından beslenir, object
+//  başına header yoktur. Kilitsizdir; her arena tek bir sahibe aittir.
+// -----------------------------------------------------------------------------
+
+typedef struct arena_chunk arena_chunk_t;
+
+typedef struct {
+    arena_chunk_t *head;          // ilk chunk (reset buraya döner)
+    arena_chunk_t *chunk;         // şu an doldurulan chunk
+    uint8_t       *cur;
+    uint8_t       *end;
+    uint64_t       chunk_frames;  // büyüme adımı
+} arena_t;
+
+/** Kapsam işareti: arena_rewind ile o noktadan sonrası geri alınır. */
+typedef struct {
+    arena_chunk_t *chunk;
+    uint8_t       *cur;
+} arena_mark_t;
+
+/** İlk chunk en az size byte; başarısızlıkta -1. */
+int   arena_init(arena_t *a, uint64_t size);
+
+/** align 2'nin kuvveti (en az 16); bellek sıfırlanmaz. */
+void *arena_alloc(arena_t *a, uint64_t size, uint64_t align);
+
+arena_mark_t arena_mark(const arena_t *a);
+void  arena_rewind(arena_t *a, arena_mark_t m);
+
+/** O(1): tüm ayırmaları geri alır, chunk'lar yeniden kullanılmak üzere kalır. */
+void  arena_reset(arena_t *a);
+
+/** Chunk'ları frame allocator'a geri verir. */
+void  arena_destroy(arena_t *a);
+
+
+// -----------------------------------------------------------------------------
+// USER ADRES ALANI (vm.c)
+// -----------------------------------------------------------------------------
+//
+//  Process başına bölge tanımları; sayfalar ilk dokunuşta #PF içinde
+//  oluşur (demand paging). Bölgeler sayfa hizalıdır, çakışamaz ve start'a
+//  göre sıralı bir dizide tutulur (ikili arama).
+// -----------------------------------------------------------------------------
+
+typedef enum {
+    VM_REGION_ANON = 0,     // sıfır sayfa
+    VM_REGION_FILE,         // src'den kopya, src_len sonrası sıfır
+    VM_REGION_STACK,        // sıfır sayfa; limit'e kadar aşağı büyür
+} vm_region_kind_t;
+
+typedef struct vm_region {
+    uint64_t          start;     // sayfa hizalı
+    uint64_t          end;       // hariç, sayfa hizalı
+    uint64_t          flags;     // PTE flag'leri (USER her zaman eklenir)
+    vm_region_kind_t  kind;
+    const uint8_t    *src;       // FILE: start'a karşılık gelen bayt
+    uint64_t          src_len;
+    uint64_t          limit;     // STACK: start'ın inebileceği en alt adres
+} vm_region_t;
+
+typedef struct vm_space {
+    uint64_t      pml4_phys;
+    vm_region_t **regions;       // start'a göre sıralı (kmalloc)
+    uint32_t      count;
+    uint32_t      cap;
+    uint64_t      resident;      // fault ile map edilen sayfa (sıfır sayfası dahil)
+} vm_space_t;
+
+/** vm_space/vm_region cache'lerini kurar (kheap_init sonrası). */
+void         vm_init(void);
+
+vm_space_t  *vm_space_create(uint64_t pml4_phys);
+
+/**
+ * src'nin bölgelerini dst_pml4_phys için kopyalar; oluşmuş sayfalar
+ * copy-on-write paylaşılır. src'nin PCID'si çağıran tarafından
+ * geçersizlenmelidir. Başarısızlıkta NULL.
+ */
+vm_space_t  *vm_space_clone(vm_space_t *src, uint64_t dst_pml4_phys);
+
+/** Bölgeleri ve oluşmuş sayfaları (frame'leriyle) serbest bırakır. */
+void         vm_space_destroy(vm_space_t *vm);
+
+/** Çakışma ya da hizasız start'ta -1. */
+int          vm_map_anon(vm_space_t *vm, uint64_t start, uint64_t size,
+                         uint64_t flags);
+
+/** src, process ömrü boyunca bellekte kalmalıdır (initrd / statik imaj). */
+int          vm_map_file(vm_space_t *vm, uint64_t start, uint64_t size,
+                         uint64_t flags, const uint8_t *src, uint64_t src_len);
+
+/** [top-size, top) ile başlar, top-max_size'a kadar büyüyebilir. */
+int          vm_map_stack(vm_space_t *vm, uint64_t top, uint64_t size,
+                          uint64_t max_size, uint64_t flags);
+
+/** addr'i içeren bölge (stack büyüme alanı dahil), O(log n). */
+vm_region_t *vm_region_find(vm_space_t *vm, uint64_t addr);
+
+/**
+ * [USER_MMAP_BASE, USER_MMAP_END) içinde size'lık anonim bölge açar;
+ * sayfalar ilk dokunuşta sıfırla oluşur. addr boş ve hizalıysa orası,
+ * değilse ilk uygun boşluk kullanılır. Başarısızlıkta 0.
+ */
+uint64_t     vm_mmap(vm_space_t *vm, uint64_t addr, uint64_t size, uint64_t flags);
+
+/**
+ * [addr, addr+size) aralığını bölgelerden çıkarır (gerekirse bölerek) ve
+ * oluşmuş sayfaları serbest bırakır. Stack bölgesine değerse -1.
+ */
+int          vm_munmap(vm_space_t *vm, uint64_t addr, uint64_t size);
+
+/**
+ * #PF çözümü: map'li olmayan sayfa bölgesine göre oluşturulur, COW
+ * sayfasına yazmada özel kopya alınır. Çözülemezse -1.
+ */
+int          vm_handle_fault(vm_space_t *vm, uint64_t addr, uint64_t err);
+
+/** Aralığı önceden oluşturur (henüz map'li olmayan sayfalar için). */
+int          vm_prefault(vm_space_t *vm, uint64_t start, uint64_t size);
+
+/** #PF girişi: current_proc'un bölgelerinde çözülürse 0. */
+int          vm_page_fault(uint64_t addr, uint64_t err);
+
 
 // -----------------------------------------------------------------------------
 // DURUM/İSTATİSTİK
@@ -133,6 +604,59 @@ void    *paging_phys_to_virt(uint64_t phys);
 uint64_t phys_get_total_frames(void);
 uint64_t phys_get_free_frames(void);
 
+/** Blok heap durumu; boş listeler kilit altında taranır (dump için). */
+typedef struct {
+    uint64_t mapped_bytes;     // map edilmiş heap
+    uint64_t free_bytes;       // boş bloklar (header/footer dahil)
+    uint64_t free_blocks;
+    uint64_t largest_free;     // en büyük boş blok
+} kheap_stats_t;
+
+void kheap_get_stats(kheap_stats_t *out);
+
+/** kmalloc slab object'inin kullanılabilir boyutu (sınıf boyutu). */
+uint64_t kslab_obj_size(const void *ptr);
+
+
+// -----------------------------------------------------------------------------
+// ALLOCATOR TELEMETRİSİ (mm_stats.c)
+// -----------------------------------------------------------------------------
+//
+//  AYKEN_MM_STATS (ayken.h) 1 iken kmalloc/kfree ve phys_alloc_frame(s)/
+//  phys_free_frame(s) çağrı yeri (return address) başına sayılır, boyutlar
+//  log2 histogramına düşer. Frame ayıran sarmalayıcılar (*_at API'leri)
+//  çağrı yeri olarak kendi çağıranlarını kaydettirir. 0 iken MM_STATS_*
+//  makroları boş açılır ve argümanları hiç değerlendirilmez.
+//  mm_stats_dump() her iki durumda da frame/heap özetini basar.
+// -----------------------------------------------------------------------------
+
+typedef enum {
+    MM_STAT_KMALLOC = 0,
+    MM_STAT_FRAME,
+    MM_STAT_KINDS
+} mm_stat_kind_t;
+
+#if AYKEN_MM_STATS
+void mm_stats_alloc(mm_stat_kind_t kind, void *site, uint64_t bytes);
+void mm_stats_site(mm_stat_kind_t kind, void *site, uint64_t bytes);
+void mm_stats_free(mm_stat_kind_t kind, uint64_t bytes);
+
+#define MM_STATS_CALLER             __builtin_return_address(0)
+#define MM_STATS_ALLOC(kind, bytes) mm_stats_alloc((kind), MM_STATS_CALLER, (bytes))
+#define MM_STATS_ALLOC_AT(kind, site, bytes) mm_stats_alloc((kind), (site), (bytes))
+// Yalnızca çağrı yeri tablosu (toplamlar başka yerde sayılmış)
+#define MM_STATS_SITE(kind, site, bytes)     mm_stats_site((kind), (site), (bytes))
+#define MM_STATS_FREE(kind, bytes)  mm_stats_free((kind), (bytes))
+#else
+#define MM_STATS_CALLER             NULL
+#define MM_STATS_ALLOC(kind, bytes) ((void)0)
+#define MM_STATS_ALLOC_AT(kind, site, bytes) ((void)0)
+#define MM_STATS_SITE(kind, site, bytes)     ((void)0)
+#define MM_STATS_FREE(kind, bytes)  ((void)0)
+#endif
+
+void mm_stats_dump(void);
+
 
 // -----------------------------------------------------------------------------
 // İLERİDE GEREKECEK OLANLAR (Multi-frame + Debug)
@@ -141,11 +665,12 @@ uint64_t phys_get_free_frames(void);
 /**
  * Birden fazla ardışık frame alloc (örn: 4 KB değil, 16 KB istendiğinde).
  * Page table oluştururken, DMA buffer'larında vb. işe yarar.
+ * Buddy allocator üzerinden O(log n); dönen adres 2^order hizalıdır.
  */
 uint64_t phys_alloc_frames(uint64_t count);
 
 /**
- * Birden fazla ardışık frame free etme.
+ * Birden fazla ardışık frame free etme (buddy'lerle otomatik birleşir).
  */
 void phys_free_frames(uint64_t phys_addr, uint64_t count);
 
@@ -153,7 +678,7 @@ void phys_free_frames(uint64_t phys_addr, uint64_t count);
  * Adresin gerçekten ayrılmış/boş olup olmadığını kontrol etmek için.
  * Debug için çok işe yarar.
  *
- * @return 1 → kullanılıyor, 0 → boş, -1 → geçersiz adres
+ * @return 1 → kullanılıyor, 0 → boş, -1 → geçersiz adres / RAM deliği
  */
 int phys_frame_is_used(uint64_t phys_addr);
 
@@ -4,6 +4,8 @@
 
 #include <stdint.h>
 
+struct vm_space;
+
 typedef struct cpu_context {
     uint64_t r15, r14, r13, r12;
     uint64_t rbx, rbp;
@@ -35,23 +37,35 @@ typedef struct proc {
     cpu_context_t context;
     uint64_t stack_top;
     uint64_t pml4_phys;   // her process'e özel (şimdilik kernel same map)
+    uint16_t pcid;        // adres alanı etiketi (bkz. paging_asid_cr3)
+    uint32_t pcid_gen;    // pcid'nin ait olduğu nesil; 0 = atanmamış
+    struct vm_space *vm;  // user bölgeleri (kernel thread'lerde NULL)
     proc_state_t state;
     proc_type_t type;
     const char *name;
     void *wait_obj;
+    int *exit_status;     // varsa çıkış kodu buraya yazılır, bekleyen uyanır
     struct proc *next;    // ready queue için
 } proc_t;
 
+// exit_status'un process çıkana kadarki değeri
+#define PROC_EXIT_PENDING  (-1)
+
 // API
 void proc_init(void);
 proc_t *proc_create_kernel_thread(void (*func)(void));
+proc_t *proc_create_idle_thread(void (*func)(void));
 void proc_create_init(void);
 proc_t *proc_create_user_process(const char *name,
                                  const uint8_t *image,
                                  uint64_t image_size,
                                  proc_image_format_t fmt);
+proc_t *proc_clone(proc_t *parent);
 void proc_launch_user_ai_service(void);
 void proc_block_current(void *wait_obj);
+void proc_reap(proc_t *p);
+// Çalışan user process'i status ile sonlandırır (SYS_EXIT); geri dönmez.
+void proc_exit_current(int status) __attribute__((noreturn));
 void proc_wake_waiters(void *wait_obj);
 
 #endif
@@ -4,6 +4,15 @@
 
 #include <stdint.h>
 
+// Syscall numaraları (RAX)
+#define SYS_MMAP        1   // (addr ipucu, size, prot) → adres
+#define SYS_MUNMAP      2   // (addr, size) → 0
+#define SYS_EXIT        3   // (status) → dönmez
+#define SYS_YIELD       4   // () → 0
+
+// SYS_MMAP prot bitleri
+#define SYS_PROT_WRITE  0x2
+
 // Syscall initialization
 void syscall_init(void);
 
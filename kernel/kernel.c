@@ -11,7 +11,7 @@
 #include <stdint.h>
 #include "include/boot_info.h"
 #include "include/mm.h"
-#include "include/sched.h"
+#include "sched/sched.h"
 #include "include/proc.h"
 #include "include/fs.h"
 #include "include/syscall.h"
@@ -108,6 +108,9 @@ static void kernel_early_init(ayken_boot_info_t *boot)
     paging_init(boot->pml4_phys);
     fb_print("[OK] Paging enabled.\n");
 
+    // Framebuffer artık PAT ile write-combining
+    fb_console_remap_wc();
+
     // ------------------------------------------------------------------------
     // 4) Kernel heap (kmalloc/kfree)
     // ------------------------------------------------------------------------
@@ -154,6 +157,10 @@ static void kernel_late_init(void)
     // ---------------------------------------------------------
     sched_init();
     proc_init();
+    vm_init();
+
+    // Idle thread: boşta kaldıkça sıfırlanmış frame havuzunu doldurur
+    proc_create_idle_thread(phys_zero_pool_worker);
     fb_print("[OK] Scheduler + Process.\n");
 
     // ---------------------------------------------------------
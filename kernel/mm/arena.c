@@ -0,0 +1,169 @@
+// kernel/mm/arena.c
+// ============================================================================
+//  AykenOS Arena (bump) Allocator
+//
+//  - Ömrü birlikte biten veriler için: boot tabloları, initrd yapıları,
+//    inference başına scratch buffer'lar. Object başına header yok,
+//    tek tek free yok; arena_reset/arena_rewind tüm bir kapsamı O(1)
+//    geri alır.
+//  - Bellek ardışık frame chunk'larından gelir (phys_alloc_frames) ve
+//    phys_to_virt penceresinden erişilir; heap penceresine dokunmaz.
+//  - Chunk dolunca yeni chunk listeye eklenir. Reset chunk'ları tutar;
+//    sonraki turlar aynı chunk'ları yeniden kullanır (map/alloc yok).
+//  - Arena kilitsizdir: sahibi tek bir bağlamdır.
+// ============================================================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../include/mm.h"
+#include "../drivers/console/fb_console.h"
+
+// Her chunk'ın başında durur; veri hemen arkasından başlar
+struct arena_chunk {
+    struct arena_chunk *next;
+    uint64_t            frames;
+    uint64_t            phys;
+    uint64_t            pad;        // veri 32 byte hizalı başlasın
+};
+
+// Chunk'lar direct map üzerinden erişilir; bundan büyük istek zaten
+// karşılanamaz. Sınır, size + align + header toplamının taşmasını da önler.
+#define ARENA_MAX_ALLOC  DIRECT_MAP_SIZE
+
+static inline uint64_t arena_align_up(uint64_t x, uint64_t a)
+{
+    return (x + a - 1) & ~(a - 1);
+}
+
+static inline uint8_t *arena_chunk_data(arena_chunk_t *c)
+{
+    return (uint8_t *)(c + 1);
+}
+
+static inline uint8_t *arena_chunk_end(arena_chunk_t *c)
+{
+    return (uint8_t *)c + c->frames * AYKEN_FRAME_SIZE;
+}
+
+static arena_chunk_t *arena_chunk_new(uint64_t frames)
+{
+    uint64_t phys = phys_alloc_frames(frames);
+    if (!phys)
+        return NULL;
+
+    arena_chunk_t *c = (arena_chunk_t *)paging_phys_to_virt(phys);
+    c->next   = NULL;
+    c->frames = frames;
+    c->phys   = phys;
+    return c;
+}
+
+// a->cur'u chunk c'nin başına al
+static inline void arena_enter(arena_t *a, arena_chunk_t *c)
+{
+    a->chunk = c;
+    a->cur   = arena_chunk_data(c);
+    a->end   = arena_chunk_end(c);
+}
+
+int arena_init(arena_t *a, uint64_t size)
+{
+    if (size > ARENA_MAX_ALLOC) {
+        a->head = a->chunk = NULL;
+        a->cur  = a->end   = NULL;
+        return -1;
+    }
+
+    uint64_t frames = arena_align_up(size + sizeof(arena_chunk_t),
+                                     AYKEN_FRAME_SIZE) / AYKEN_FRAME_SIZE;
+
+    arena_chunk_t *c = arena_chunk_new(frames);
+    if (!c) {
+        a->head = a->chunk = NULL;
+        a->cur  = a->end   = NULL;
+        return -1;
+    }
+
+    a->head         = c;
+    a->chunk_frames = frames;
+    arena_enter(a, c);
+    return 0;
+}
+
+void *arena_alloc(arena_t *a, uint64_t size, uint64_t align)
+{
+    if (!a->head || size == 0)
+        return NULL;
+    if (size > ARENA_MAX_ALLOC || align > ARENA_MAX_ALLOC)
+        return NULL;
+    if (align < 16)
+        align = 16;
+
+    for (;;) {
+        uint8_t *p = (uint8_t *)arena_align_up((uint64_t)a->cur, align);
+        if (p <= a->end && size <= (uint64_t)(a->end - p)) {
+            a->cur = p + size;
+            return p;
+        }
+
+        // Reset'ten kalan bir sonraki chunk yeterliyse onu kullan
+        arena_chunk_t *next = a->chunk->next;
+        uint64_t need = size + align + sizeof(arena_chunk_t);
+
+        if (next && (uint64_t)(arena_chunk_end(next) - (uint8_t *)next) >= need) {
+            arena_enter(a, next);
+            continue;
+        }
+
+        uint64_t frames = arena_align_up(need, AYKEN_FRAME_SIZE) / AYKEN_FRAME_SIZE;
+        if (frames < a->chunk_frames)
+            frames = a->chunk_frames;
+
+        arena_chunk_t *c = arena_chunk_new(frames);
+        if (!c) {
+            fb_print("[arena] WARNING: out of memory.\n");
+            return NULL;
+        }
+
+        // Yeni chunk mevcut olanın hemen arkasına girer; sonraki (küçük)
+        // chunk'lar listede kalır ve yeniden kullanılabilir.
+        c->next = next;
+        a->chunk->next = c;
+        arena_enter(a, c);
+    }
+}
+
+arena_mark_t arena_mark(const arena_t *a)
+{
+    arena_mark_t m = { a->chunk, a->cur };
+    return m;
+}
+
+void arena_rewind(arena_t *a, arena_mark_t m)
+{
+    if (!m.chunk)
+        return;
+
+    a->chunk = m.chunk;
+    a->cur   = m.cur;
+    a->end   = arena_chunk_end(m.chunk);
+}
+
+void arena_reset(arena_t *a)
+{
+    if (a->head)
+        arena_enter(a, a->head);
+}
+
+void arena_destroy(arena_t *a)
+{
+    arena_chunk_t *c = a->head;
+    while (c) {
+        arena_chunk_t *next = c->next;
+        phys_free_frames(c->phys, c->frames);
+        c = next;
+    }
+
+    a->head = a->chunk = NULL;
+    a->cur  = a->end   = NULL;
+}
@@ -2,10 +2,20 @@
 // ============================================================================
 //  AykenOS Kernel Heap (kmalloc / kfree)
 //
-//  - KHEAP_START adresinden itibaren belirli bir sanal aralığı "heap" olarak
-//    kullanır.
-//  - Bu aralığı phys_alloc_frame() + paging_map_page() ile fiziksel RAM'e map eder.
-//  - Üzerinde basit bir free-list tabanlı allocator (first-fit) çalışır.
+//  - KHEAP_START adresinden itibaren KHEAP_WINDOW_SIZE'lık rezerve sanal
+//    aralığı "heap" olarak kullanır.
+//  - Boot'ta yalnızca KHEAP_INITIAL_SIZE map edilir; boş blok kalmayınca
+//    heap KHEAP_GROW_CHUNK adımlarla phys_alloc_frame() + paging_map_page()
+//    ile büyür, sondaki tamamen boş chunk'lar phys_free_frame()'e döner.
+//    Büyümenin 2MB hizalı tam dilimleri 2MB sayfalarla map edilir; map/unmap
+//    paging range API'si üzerinden tek tablo yürüyüşü + tek TLB flush'tır.
+//  - Bloklar boundary tag taşır (header + footer): kfree fiziksel
+//    komşularla O(1) birleşir, heap listesinde yürümez.
+//  - Boş bloklar log2 boyut bucket'larına ayrılmış (segregated) listelerde
+//    durur; dolu olmayan bucket'lar bir bitmap'te tutulur, kmalloc uygun
+//    bucket'ı tzcnt ile bulur ve dolu bloklara hiç bakmaz.
+//  - KSLAB_MAX_SIZE ve altındaki istekler slab katmanına (slab.c) gider;
+//    bu blok heap yalnızca sayfa katına yuvarlanmış büyük istekleri görür.
 // ============================================================================
 
 #include <stdint.h>
@@ -13,18 +23,14 @@
 #include "../include/ayken.h"
 #include "../include/mm.h"
 #include "../drivers/console/fb_console.h"
+#include "../arch/x86_64/spinlock.h"
 
 // ---------------------------------------------------------------------------
 // Heap adres aralığı
 // ---------------------------------------------------------------------------
 //
-// Not: KERNEL_VIRT_BASE ayken.h içinde tanımlı olmalı.
-// Örn: #define KERNEL_VIRT_BASE 0xFFFFFFFF80000000ULL
-//
-// Burada heap'i kernel sanal adres alanında biraz yukarıdan başlatıyoruz.
-
-#define KHEAP_START        (KERNEL_VIRT_BASE + 0x01000000ULL)   // +16MB offset
-#define KHEAP_INITIAL_SIZE (16ULL * 1024ULL * 1024ULL)          // 16 MiB heap
+// KHEAP_START / KHEAP_INITIAL_SIZE mm.h içinde: pencerenin ilk kısmı
+// slab chunk'larına ayrılmış, blok heap onun hemen arkasından başlıyor.
 
 // Alignment (8 veya 16 byte yeterli)
 #define KHEAP_ALIGN        16ULL
@@ -35,123 +41,345 @@ static inline uint64_t align_up(uint64_t x, uint64_t a)
 }
 
 // ---------------------------------------------------------------------------
-// Heap blok yapısı
+// Heap blok yapısı (boundary tag)
 // ---------------------------------------------------------------------------
 //
-// [block_header][kullanıcı verisi ... ]
+// [header][kullanıcı verisi ... ][footer]
 //
-// block_header:
-//   size = bu bloktaki "veri" alanının uzunluğu (header hariç)
-//   free = 1 ise boş, 0 ise dolu
-//   next = linked list'te bir sonraki blok
+// header.size: bloğun tamamı (header + veri + footer), KHEAP_ALIGN katı;
+//              bit 0 = KHEAP_BLOCK_FREE
+// footer     : bloğun son 8 byte'ı, header.size'ın kopyası → bir sonraki
+//              blok, önceki komşusunun başına footer üzerinden ulaşır.
+//
+// Boş blokların veri alanı bucket listesi bağlantılarını taşır.
+// Heap'in başında dolu bir prologue, sonunda boyutu 0 olan dolu bir
+// epilogue header'ı durur; böylece komşu kontrolleri sınır testi istemez.
 // ---------------------------------------------------------------------------
 
 typedef struct kheap_block {
     uint64_t size;
-    int      free;
-    struct kheap_block *next;
+    uint64_t magic;
 } kheap_block_t;
 
-static kheap_block_t *kheap_head = NULL;
+typedef struct kheap_free {
+    kheap_block_t      hdr;
+    struct kheap_free *next;
+    struct kheap_free *prev;
+} kheap_free_t;
+
+#define KHEAP_BLOCK_FREE   1ULL
+#define KHEAP_MAGIC        0x4B48454150424C4BULL   // "KHEAPBLK"
+#define KHEAP_FOOTER_SIZE  sizeof(uint64_t)
+#define KHEAP_OVERHEAD     (sizeof(kheap_block_t) + KHEAP_FOOTER_SIZE)
+#define KHEAP_MIN_BLOCK    align_up(sizeof(kheap_free_t) + KHEAP_FOOTER_SIZE, KHEAP_ALIGN)
+#define KHEAP_BUCKETS      64
+
+static kheap_free_t *g_kheap_bucket[KHEAP_BUCKETS];
+static uint64_t      g_kheap_bucket_map = 0;     // bit b → bucket b boş değil
+
+static uint64_t   g_kheap_end  = 0;   // epilogue header'ının adresi
+static uint64_t   g_kheap_mapped_end = 0;   // map edilmiş bölgenin sonu (chunk hizalı)
+static uint64_t   g_kheap_free = 0;   // boş byte (header/footer dahil)
+static int        g_kheap_ready = 0;
+static spinlock_t g_kheap_lock = SPINLOCK_INIT;
+
+
+// ============================================================================
+//  Blok yardımcıları
+// ============================================================================
+
+static inline uint64_t blk_size(const kheap_block_t *b)
+{
+    return b->size & ~KHEAP_BLOCK_FREE;
+}
+
+static inline int blk_free(const kheap_block_t *b)
+{
+    return (b->size & KHEAP_BLOCK_FREE) != 0;
+}
+
+static inline kheap_block_t *blk_next(kheap_block_t *b)
+{
+    return (kheap_block_t *)((uint8_t *)b + blk_size(b));
+}
+
+// Önceki bloğun footer'ı bu bloğun hemen önünde
+static inline kheap_block_t *blk_prev(kheap_block_t *b)
+{
+    uint64_t prev_size = ((uint64_t *)b)[-1] & ~KHEAP_BLOCK_FREE;
+    return (kheap_block_t *)((uint8_t *)b - prev_size);
+}
+
+static inline void blk_set(kheap_block_t *b, uint64_t size, int free)
+{
+    uint64_t tag = size | (free ? KHEAP_BLOCK_FREE : 0);
+    b->size  = tag;
+    b->magic = KHEAP_MAGIC;
+    *(uint64_t *)((uint8_t *)b + size - KHEAP_FOOTER_SIZE) = tag;
+}
+
+// floor(log2(size)): bucket b, [2^b, 2^(b+1)) boyutlu blokları tutar
+static inline uint32_t kheap_bucket_of(uint64_t size)
+{
+    return 63u - (uint32_t)__builtin_clzll(size);
+}
+
+static void kheap_list_insert(kheap_block_t *b)
+{
+    kheap_free_t *f = (kheap_free_t *)b;
+    uint32_t bucket = kheap_bucket_of(blk_size(b));
+
+    f->prev = NULL;
+    f->next = g_kheap_bucket[bucket];
+    if (f->next)
+        f->next->prev = f;
+    g_kheap_bucket[bucket] = f;
+    g_kheap_bucket_map |= (1ULL << bucket);
+}
+
+static void kheap_list_remove(kheap_block_t *b)
+{
+    kheap_free_t *f = (kheap_free_t *)b;
+    uint32_t bucket = kheap_bucket_of(blk_size(b));
+
+    if (f->prev)
+        f->prev->next = f->next;
+    else
+        g_kheap_bucket[bucket] = f->next;
+    if (f->next)
+        f->next->prev = f->prev;
+
+    if (!g_kheap_bucket[bucket])
+        g_kheap_bucket_map &= ~(1ULL << bucket);
+}
+
+// need byte'lık blok için aday:
+//  1) need'in kendi bucket'ı → blokları need'den küçük olabilir, first-fit
+//  2) daha üst bucket'lar → ilk bloğu her zaman yeter (bitmap + tzcnt)
+static kheap_block_t *kheap_find_fit(uint64_t need)
+{
+    uint32_t bucket = kheap_bucket_of(need);
+
+    for (kheap_free_t *f = g_kheap_bucket[bucket]; f; f = f->next) {
+        if (blk_size(&f->hdr) >= need)
+            return &f->hdr;
+    }
+
+    if (bucket + 1 >= KHEAP_BUCKETS)
+        return NULL;
+
+    uint64_t above = g_kheap_bucket_map & (~0ULL << (bucket + 1));
+    if (!above)
+        return NULL;
+
+    return &g_kheap_bucket[__builtin_ctzll(above)]->hdr;
+}
+
+
+// ============================================================================
+//  Pencere map/unmap (KHEAP_GROW_CHUNK katları)
+// ============================================================================
+
+// [start, end) sayfalarını geri ver (tek TLB flush)
+static void kheap_unmap_range(uint64_t start, uint64_t end)
+{
+    paging_unmap_range(start, end - start, 1);
+}
+
+// [start, end) sayfalarını map et; başarısızlıkta yarım kalanı geri alır.
+// 2MB hizalı tam dilimler büyük sayfa olur (bkz. paging_map_anon).
+static int kheap_map_range(uint64_t start, uint64_t end)
+{
+    return paging_map_anon(start, end - start, 0);
+}
+
+// En az need byte'lık boş blok oluşacak kadar heap'i büyüt.
+// Eski epilogue yeni boş bloğun header'ı olur; soldaki boş blokla birleşir.
+static int kheap_grow(uint64_t need)
+{
+    uint64_t grow    = align_up(need + sizeof(kheap_block_t), KHEAP_GROW_CHUNK);
+    uint64_t new_end = g_kheap_mapped_end + grow;
+
+    if (new_end > KHEAP_START + KHEAP_WINDOW_SIZE)
+        return -1;
+    if (kheap_map_range(g_kheap_mapped_end, new_end) != 0)
+        return -1;
+
+    kheap_block_t *b = (kheap_block_t *)g_kheap_end;
+    uint64_t size = (new_end - sizeof(kheap_block_t)) - g_kheap_end;
+
+    g_kheap_mapped_end = new_end;
+    g_kheap_end        = new_end - sizeof(kheap_block_t);
+    g_kheap_free      += size;
+
+    kheap_block_t *epilogue = (kheap_block_t *)g_kheap_end;
+    epilogue->size  = 0;
+    epilogue->magic = KHEAP_MAGIC;
+
+    kheap_block_t *prev = blk_prev(b);
+    if (blk_free(prev)) {
+        kheap_list_remove(prev);
+        size += blk_size(prev);
+        b = prev;
+    }
+
+    blk_set(b, size, 1);
+    kheap_list_insert(b);
+    return 0;
+}
+
+// b: heap'in son bloğu ve boş (listede değil). Sondaki tamamen boş
+// chunk'ları geri ver; bir chunk'lık pay bırak ki alloc/free salınımı
+// sürekli map/unmap yapmasın. b'nin yeni boyutunu döner.
+static uint64_t kheap_trim(kheap_block_t *b, uint64_t size)
+{
+    uint64_t keep_end = align_up((uint64_t)b + KHEAP_MIN_BLOCK + sizeof(kheap_block_t),
+                                 KHEAP_GROW_CHUNK) + KHEAP_GROW_CHUNK;
+    if (keep_end < KHEAP_START + KHEAP_INITIAL_SIZE)
+        keep_end = KHEAP_START + KHEAP_INITIAL_SIZE;
+    if (keep_end >= g_kheap_mapped_end)
+        return size;
+
+    uint64_t old_end = g_kheap_mapped_end;
+
+    g_kheap_mapped_end = keep_end;
+    g_kheap_end        = keep_end - sizeof(kheap_block_t);
+
+    kheap_block_t *epilogue = (kheap_block_t *)g_kheap_end;
+    epilogue->size  = 0;
+    epilogue->magic = KHEAP_MAGIC;
+
+    uint64_t new_size = g_kheap_end - (uint64_t)b;
+    g_kheap_free -= size - new_size;
+
+    kheap_unmap_range(keep_end, old_end);
+    return new_size;
+}
 
 
 // ============================================================================
 //  kheap_init
-//  - KHEAP_START'tan itibaren KHEAP_INITIAL_SIZE kadar sanal alanı
-//    fiziksel frame'lerle doldurur ve tek büyük boş blok oluşturur.
+//  - Rezerve pencerenin PML4 girişini oluşturur (user PML4'ler paylaşsın)
+//  - Yalnızca KHEAP_INITIAL_SIZE kadarını map edip tek büyük boş blok kurar
 // ============================================================================
 
 void kheap_init(void)
 {
     fb_print("[kheap] Initializing kernel heap...\n");
 
-    // 1) Heap aralığını sayfalara böl
-    uint64_t heap_pages = KHEAP_INITIAL_SIZE / AYKEN_FRAME_SIZE;
-    if (KHEAP_INITIAL_SIZE % AYKEN_FRAME_SIZE)
-        heap_pages++;
+    // Slab + blok heap aynı PML4 girişinde; user PML4'ler oluşturulmadan
+    // önce PDPT hazır olmalı (lazy map'ler her adres alanında görünür).
+    paging_reserve_kernel_slot(KHEAP_WINDOW_BASE);
 
-    uint64_t cur_virt = KHEAP_START;
+    kslab_init();
 
-    for (uint64_t i = 0; i < heap_pages; ++i) {
-        uint64_t phys = phys_alloc_frame();
-        if (!phys) {
-            fb_print("[kheap] ERROR: phys_alloc_frame failed while setting up heap.\n");
-            return;
-        }
+    for (uint32_t i = 0; i < KHEAP_BUCKETS; ++i)
+        g_kheap_bucket[i] = NULL;
+    g_kheap_bucket_map = 0;
 
-        // Kernel sayfası: varsayılan flags = 0 → paging_map_page içinde
-        // AYKEN_PTE_KERNEL_FLAGS eklenecek.
-        paging_map_page(cur_virt, phys, 0);
-
-        cur_virt += AYKEN_FRAME_SIZE;
+    // 1) Başlangıç bölgesini map et
+    uint64_t initial = align_up(KHEAP_INITIAL_SIZE, KHEAP_GROW_CHUNK);
+    if (kheap_map_range(KHEAP_START, KHEAP_START + initial) != 0) {
+        fb_print("[kheap] ERROR: failed to map initial heap window.\n");
+        return;
     }
+    g_kheap_mapped_end = KHEAP_START + initial;
+
+    // 2) Prologue (dolu) + tek büyük boş blok + epilogue (size 0, dolu)
+    kheap_block_t *prologue = (kheap_block_t *)KHEAP_START;
+    blk_set(prologue, KHEAP_OVERHEAD + KHEAP_FOOTER_SIZE, 0);
+
+    g_kheap_end = g_kheap_mapped_end - sizeof(kheap_block_t);
+    kheap_block_t *epilogue = (kheap_block_t *)g_kheap_end;
+    epilogue->size  = 0;
+    epilogue->magic = KHEAP_MAGIC;
 
-    // 2) Tek büyük boş blok oluştur
-    kheap_head = (kheap_block_t *)KHEAP_START;
-    kheap_head->size = (heap_pages * AYKEN_FRAME_SIZE) - sizeof(kheap_block_t);
-    kheap_head->free = 1;
-    kheap_head->next = NULL;
+    kheap_block_t *first = blk_next(prologue);
+    uint64_t first_size  = g_kheap_end - (uint64_t)first;
+    blk_set(first, first_size, 1);
+    kheap_list_insert(first);
+
+    g_kheap_free  = first_size;
+    g_kheap_ready = 1;
 
     fb_print("[kheap] Heap initialized at ");
-    fb_print_hex64((uint64_t)KHEAP_START);
+    fb_print_hex((uint64_t)KHEAP_START);
     fb_print(" size=");
-    fb_print_hex64(kheap_head->size);
+    fb_print_uint(first_size);
+    fb_print(" window=");
+    fb_print_uint(KHEAP_WINDOW_SIZE);
     fb_print("\n");
 }
 
 
 // ============================================================================
 //  kmalloc
-//  - Basit first-fit algoritması
-//  - Gerekirse blokları böler
+//  - Küçük istekler: slab boyut sınıfları (O(1))
+//  - Büyük istekler: sayfa katına yuvarlanır, segregated listelerden
+//    uygun boş blok alınır
+//  - Gerekirse blokları böler; kalan parça kendi bucket'ına döner
 // ============================================================================
 
 void *kmalloc(uint64_t size)
 {
-    if (size == 0 || !kheap_head)
+    if (size == 0)
         return NULL;
 
-    // Alignment uygulayalım
-    size = align_up(size, KHEAP_ALIGN);
+    if (size <= KSLAB_MAX_SIZE) {
+        void *obj = kslab_alloc(size);
+        if (obj)
+            MM_STATS_ALLOC(MM_STAT_KMALLOC, kslab_obj_size(obj));
+        return obj;
+    }
 
-    kheap_block_t *current = kheap_head;
+    // Pencereden büyük istek hiçbir zaman karşılanamaz; yuvarlamadan önce
+    // reddet ki ~0 gibi boyutlar align_up'ta sarıp küçük blok dönmesin.
+    if (!g_kheap_ready || size > KHEAP_WINDOW_SIZE)
+        return NULL;
 
-    while (current) {
-        if (current->free && current->size >= size) {
-            // Gerekirse bloğu böl
-            uint64_t remaining = current->size - size;
+    // Sayfa granülerliği: büyük bloklar az sayıda ve kaba taneli kalır
+    size = align_up(size, AYKEN_FRAME_SIZE);
+    uint64_t need = align_up(size + KHEAP_OVERHEAD, KHEAP_ALIGN);
 
-            if (remaining > sizeof(kheap_block_t) + KHEAP_ALIGN) {
-                // Yeni bir blok oluştur
-                uint8_t *block_end = (uint8_t *)current + sizeof(kheap_block_t) + size;
-                kheap_block_t *new_block = (kheap_block_t *)block_end;
+    uint64_t flags = spin_lock_irqsave(&g_kheap_lock);
 
-                new_block->size = remaining - sizeof(kheap_block_t);
-                new_block->free = 1;
-                new_block->next = current->next;
+    kheap_block_t *b = kheap_find_fit(need);
+    if (!b && kheap_grow(need) == 0)
+        b = kheap_find_fit(need);
+    if (!b) {
+        spin_unlock_irqrestore(&g_kheap_lock, flags);
+        fb_print("[kheap] WARNING: kmalloc out of memory.\n");
+        return NULL;
+    }
+
+    kheap_list_remove(b);
 
-                current->size = size;
-                current->next = new_block;
-            }
+    uint64_t total = blk_size(b);
+    if (total - need >= KHEAP_MIN_BLOCK) {
+        // Kalan parça: sağ komşusu dolu olduğundan birleştirme gerekmez
+        kheap_block_t *rest = (kheap_block_t *)((uint8_t *)b + need);
+        blk_set(rest, total - need, 1);
+        kheap_list_insert(rest);
+        total = need;
+    }
 
-            current->free = 0;
+    blk_set(b, total, 0);
+    g_kheap_free -= total;
 
-            // Kullanıcıya dönecek adres: header'dan sonraki alan
-            return (void *)((uint8_t *)current + sizeof(kheap_block_t));
-        }
+    spin_unlock_irqrestore(&g_kheap_lock, flags);
 
-        current = current->next;
-    }
+    MM_STATS_ALLOC(MM_STAT_KMALLOC, total - KHEAP_OVERHEAD);
 
-    // Şimdilik heap genişletmiyoruz; ileride "heap grow" eklenebilir.
-    fb_print("[kheap] WARNING: kmalloc out of memory.\n");
-    return NULL;
+    // Kullanıcıya dönecek adres: header'dan sonraki alan
+    return (void *)((uint8_t *)b + sizeof(kheap_block_t));
 }
 
 
 // ============================================================================
 //  kfree
-//  - Bloğu free yapar, bitişik boş bloklarla birleştirir (coalesce).
+//  - Bloğu free yapar; boundary tag'ler sayesinde yalnızca iki fiziksel
+//    komşuya bakarak O(1) birleştirir (coalesce).
+//  - Birleşen blok heap'in sonuna değiyorsa fazla chunk'lar unmap edilir.
 // ============================================================================
 
 void kfree(void *ptr)
@@ -159,21 +387,79 @@ void kfree(void *ptr)
     if (!ptr)
         return;
 
+    if (kslab_owns(ptr)) {
+        MM_STATS_FREE(MM_STAT_KMALLOC, kslab_obj_size(ptr));
+        kslab_free(ptr);
+        return;
+    }
+
     // Pointer'ı header'a geri çek
-    kheap_block_t *block = (kheap_block_t *)((uint8_t *)ptr - sizeof(kheap_block_t));
-    block->free = 1;
-
-    // Bitişik boş blokları birleştir
-    kheap_block_t *current = kheap_head;
-
-    while (current) {
-        if (current->free) {
-            // Sonraki blok da boşsa birleştir
-            while (current->next && current->next->free) {
-                current->size += sizeof(kheap_block_t) + current->next->size;
-                current->next = current->next->next;
-            }
+    kheap_block_t *b = (kheap_block_t *)((uint8_t *)ptr - sizeof(kheap_block_t));
+    if (b->magic != KHEAP_MAGIC || blk_free(b)) {
+        fb_print("[kheap] ERROR: invalid or double kfree.\n");
+        return;
+    }
+
+    MM_STATS_FREE(MM_STAT_KMALLOC, blk_size(b) - KHEAP_OVERHEAD);
+
+    uint64_t flags = spin_lock_irqsave(&g_kheap_lock);
+
+    uint64_t size = blk_size(b);
+    g_kheap_free += size;
+
+    // Sağ komşu boşsa yut
+    kheap_block_t *next = blk_next(b);
+    if (blk_free(next)) {
+        kheap_list_remove(next);
+        size += blk_size(next);
+        next->magic = 0;
+    }
+
+    // Sol komşu boşsa ona katıl (prologue hiçbir zaman boş değil)
+    kheap_block_t *prev = blk_prev(b);
+    if (blk_free(prev)) {
+        kheap_list_remove(prev);
+        size += blk_size(prev);
+        b->magic = 0;   // yutulan header tekrar kfree'lenemesin
+        b = prev;
+    }
+
+    // Heap'in sonuna kadar boşsa fazla chunk'ları sisteme geri ver
+    if ((uint64_t)b + size == g_kheap_end)
+        size = kheap_trim(b, size);
+
+    blk_set(b, size, 1);
+    kheap_list_insert(b);
+
+    spin_unlock_irqrestore(&g_kheap_lock, flags);
+}
+
+
+// ============================================================================
+//  kheap_get_stats
+//  - Boş listeleri yürür; yalnızca dump/teşhis yolunda çağrılır.
+// ============================================================================
+
+void kheap_get_stats(kheap_stats_t *out)
+{
+    if (!out)
+        return;
+
+    uint64_t flags = spin_lock_irqsave(&g_kheap_lock);
+
+    out->mapped_bytes = g_kheap_ready ? g_kheap_mapped_end - KHEAP_START : 0;
+    out->free_bytes   = g_kheap_free;
+    out->free_blocks  = 0;
+    out->largest_free = 0;
+
+    for (uint32_t i = 0; i < KHEAP_BUCKETS; ++i) {
+        for (kheap_free_t *f = g_kheap_bucket[i]; f; f = f->next) {
+            uint64_t size = blk_size(&f->hdr);
+            out->free_blocks++;
+            if (size > out->largest_free)
+                out->largest_free = size;
         }
-        current = current->next;
     }
+
+    spin_unlock_irqrestore(&g_kheap_lock, flags);
 }
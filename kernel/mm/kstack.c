@@ -0,0 +1,129 @@
+// kernel/mm/kstack.c
+// ============================================================================
+//  AykenOS Kernel Stack Cache
+//
+//  - Kernel stack'leri kmalloc'tan değil, KSTACK_START penceresindeki sabit
+//    boyutlu slot'lardan verilir. Her slot'un alt KSTACK_GUARD_SIZE'ı hiç
+//    map edilmez: stack taşması sessizce komşu object'i bozmak yerine
+//    guard sayfasında #PF üretir. #PF kendi IST stack'inde çalıştığından
+//    handler adresi basar ve sistemi durdurur (user process'inse onu
+//    sonlandırır); #DF de ayrı IST'tedir, reset yerine tanı kalır.
+//  - Stack alanı sayfa hizalıdır (kmalloc(4096) hizalama garantisi vermiyordu).
+//  - Serbest bırakılan stack'ler map'li halde KSTACK_CACHE_MAX'a kadar
+//    intrusive bir listede sıcak bekler; alloc O(1) pop'tur, map/unmap yok.
+//    Fazlası unmap edilir ve slot indeksi yeniden kullanılmak üzere saklanır.
+// ============================================================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../include/ayken.h"
+#include "../include/mm.h"
+#include "../drivers/console/fb_console.h"
+#include "../arch/x86_64/spinlock.h"
+
+#define KSTACK_SLOT_SIZE   (KSTACK_GUARD_SIZE + KSTACK_SIZE)
+#define KSTACK_SLOTS       (KSTACK_WINDOW_SIZE / KSTACK_SLOT_SIZE)
+#define KSTACK_PAGES       (KSTACK_SIZE / AYKEN_FRAME_SIZE)
+
+// Map'li tutulan en fazla serbest stack
+#define KSTACK_CACHE_MAX   16
+
+// Map'li serbest stack'in en alt word'ü bir sonrakini gösterir
+typedef struct kstack_free {
+    struct kstack_free *next;
+} kstack_free_t;
+
+static spinlock_t     g_kstack_lock = SPINLOCK_INIT;
+static kstack_free_t *g_kstack_cache = NULL;
+static uint32_t       g_kstack_cached = 0;
+
+// Unmap edilmiş slot'lar: bump pointer + geri dönen indeksler
+static uint32_t g_kstack_next = 0;
+static uint32_t g_kstack_slots[KSTACK_SLOTS];
+static uint32_t g_kstack_slot_count = 0;
+
+static inline uint64_t kstack_slot_base(uint32_t idx)
+{
+    // Guard'ın hemen üstü: stack alanının en alt adresi
+    return KSTACK_START + (uint64_t)idx * KSTACK_SLOT_SIZE + KSTACK_GUARD_SIZE;
+}
+
+static inline uint32_t kstack_slot_index(uint64_t base)
+{
+    return (uint32_t)((base - KSTACK_START) / KSTACK_SLOT_SIZE);
+}
+
+static void kstack_unmap(uint64_t base, uint64_t pages)
+{
+    paging_unmap_range(base, pages * AYKEN_FRAME_SIZE, 1);
+}
+
+static void kstack_slot_put(uint32_t idx)
+{
+    uint64_t flags = spin_lock_irqsave(&g_kstack_lock);
+    g_kstack_slots[g_kstack_slot_count++] = idx;
+    spin_unlock_irqrestore(&g_kstack_lock, flags);
+}
+
+uint64_t kstack_alloc(void)
+{
+    uint64_t flags = spin_lock_irqsave(&g_kstack_lock);
+
+    // Fast path: sıcak, zaten map'li stack
+    kstack_free_t *f = g_kstack_cache;
+    if (f) {
+        g_kstack_cache = f->next;
+        g_kstack_cached--;
+        spin_unlock_irqrestore(&g_kstack_lock, flags);
+        return (uint64_t)f + KSTACK_SIZE;
+    }
+
+    uint32_t idx;
+    if (g_kstack_slot_count) {
+        idx = g_kstack_slots[--g_kstack_slot_count];
+    } else if (g_kstack_next < KSTACK_SLOTS) {
+        idx = g_kstack_next++;
+    } else {
+        spin_unlock_irqrestore(&g_kstack_lock, flags);
+        fb_print("[kstack] ERROR: kernel stack window exhausted.\n");
+        return 0;
+    }
+    spin_unlock_irqrestore(&g_kstack_lock, flags);
+
+    uint64_t base = kstack_slot_base(idx);
+
+    // Guard sayfası dışarıda kalır; başarısızlıkta hiçbir sayfa map'li kalmaz
+    if (paging_map_anon(base, KSTACK_SIZE, 0) != 0) {
+        kstack_slot_put(idx);
+        return 0;
+    }
+
+    return base + KSTACK_SIZE;
+}
+
+void kstack_free(uint64_t top)
+{
+    if (!top)
+        return;
+
+    uint64_t base = top - KSTACK_SIZE;
+    if (base < KSTACK_START || base >= KSTACK_START + KSTACK_WINDOW_SIZE ||
+        base != kstack_slot_base(kstack_slot_index(base))) {
+        fb_print("[kstack] ERROR: kstack_free on foreign pointer.\n");
+        return;
+    }
+
+    uint64_t flags = spin_lock_irqsave(&g_kstack_lock);
+    if (g_kstack_cached < KSTACK_CACHE_MAX) {
+        kstack_free_t *f = (kstack_free_t *)base;
+        f->next = g_kstack_cache;
+        g_kstack_cache = f;
+        g_kstack_cached++;
+        spin_unlock_irqrestore(&g_kstack_lock, flags);
+        return;
+    }
+    spin_unlock_irqrestore(&g_kstack_lock, flags);
+
+    kstack_unmap(base, KSTACK_PAGES);
+    kstack_slot_put(kstack_slot_index(base));
+}
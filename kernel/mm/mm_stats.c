@@ -0,0 +1,235 @@
+// kernel/mm/mm_stats.c
+// ============================================================================
+//  AykenOS Allocator Telemetrisi
+//
+//  - AYKEN_MM_STATS=1: kmalloc/kfree ve frame allocator hook'ları buraya
+//    düşer. Her ayırma, çağıranın return address'i ile küçük bir açık
+//    adresli tabloda sayılır ("kim ne kadar istedi"); boyutlar log2
+//    histogramına yazılır. Sarmalayıcılar (sıfır havuzu, paging_map_anon)
+//    kendi çağıranlarını geçirdiği için satırlar allocator iç
+//    fonksiyonlarını değil belleğin sahibini gösterir. Free tarafında
+//    çağrı yeri bilinmediği için yalnızca tür bazında canlı byte / tepe
+//    değer tutulur.
+//  - Tür başına tablo dolarsa yeni çağrı yerleri "other" satırında toplanır.
+//  - mm_stats_dump(): frame allocator, zero pool ve blok heap
+//    fragmentasyon özeti her zaman; sayaçlar yalnızca flag açıkken basılır.
+//    Adresler sembol tablosuyla (nm kernel.elf) eşleştirilebilir.
+// ============================================================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../include/ayken.h"
+#include "../include/mm.h"
+#include "../drivers/console/fb_console.h"
+#include "../arch/x86_64/spinlock.h"
+
+#if AYKEN_MM_STATS
+
+#define MM_STATS_SITES    64      // tür başına; 2'nin kuvveti (hash maskesi)
+#define MM_STATS_HIST     24      // 2^0 .. 2^23+ byte
+#define MM_STATS_TOP      8       // dump'ta tür başına gösterilen çağrı yeri
+
+typedef struct {
+    uint64_t site;
+    uint64_t allocs;
+    uint64_t bytes;
+} mm_site_t;
+
+typedef struct {
+    uint64_t allocs;
+    uint64_t frees;
+    uint64_t live_bytes;
+    uint64_t peak_bytes;
+    uint64_t other_allocs;     // tabloya sığmayan çağrı yerleri
+    uint64_t hist[MM_STATS_HIST];
+} mm_kind_stats_t;
+
+static mm_site_t       g_mm_sites[MM_STAT_KINDS][MM_STATS_SITES];
+static mm_kind_stats_t g_mm_kind[MM_STAT_KINDS];
+static spinlock_t      g_mm_stats_lock = SPINLOCK_INIT;
+
+static const char *const g_mm_kind_name[MM_STAT_KINDS] = {
+    "kmalloc",
+    "frame",
+};
+
+static inline uint32_t mm_hist_bucket(uint64_t bytes)
+{
+    uint32_t b = bytes ? 63u - (uint32_t)__builtin_clzll(bytes) : 0;
+    return b < MM_STATS_HIST ? b : MM_STATS_HIST - 1;
+}
+
+// Çağrı yerinin slotu; tablo doluysa NULL
+static mm_site_t *mm_site_lookup(uint64_t site, mm_stat_kind_t kind)
+{
+    uint32_t h = (uint32_t)((site >> 4) * 0x9E3779B1u) & (MM_STATS_SITES - 1);
+
+    for (uint32_t i = 0; i < MM_STATS_SITES; ++i) {
+        mm_site_t *s = &g_mm_sites[kind][(h + i) & (MM_STATS_SITES - 1)];
+        if (s->site == site)
+            return s;
+        if (!s->site) {
+            s->site = site;
+            return s;
+        }
+    }
+    return NULL;
+}
+
+void mm_stats_alloc(mm_stat_kind_t kind, void *site, uint64_t bytes)
+{
+    uint64_t flags = spin_lock_irqsave(&g_mm_stats_lock);
+
+    mm_kind_stats_t *k = &g_mm_kind[kind];
+    k->allocs++;
+    k->live_bytes += bytes;
+    if (k->live_bytes > k->peak_bytes)
+        k->peak_bytes = k->live_bytes;
+    k->hist[mm_hist_bucket(bytes)]++;
+
+    mm_site_t *s = mm_site_lookup((uint64_t)site, kind);
+    if (s) {
+        s->allocs++;
+        s->bytes += bytes;
+    } else {
+        k->other_allocs++;
+    }
+
+    spin_unlock_irqrestore(&g_mm_stats_lock, flags);
+}
+
+// Toplamlar başka bir çağrı yerinde sayılmış bellek için yalnızca
+// sahip satırı (ör. sıfır havuzundan verilen frame)
+void mm_stats_site(mm_stat_kind_t kind, void *site, uint64_t bytes)
+{
+    uint64_t flags = spin_lock_irqsave(&g_mm_stats_lock);
+
+    mm_site_t *s = mm_site_lookup((uint64_t)site, kind);
+    if (s) {
+        s->allocs++;
+        s->bytes += bytes;
+    }
+
+    spin_unlock_irqrestore(&g_mm_stats_lock, flags);
+}
+
+void mm_stats_free(mm_stat_kind_t kind, uint64_t bytes)
+{
+    uint64_t flags = spin_lock_irqsave(&g_mm_stats_lock);
+
+    mm_kind_stats_t *k = &g_mm_kind[kind];
+    k->frees++;
+    k->live_bytes = k->live_bytes > bytes ? k->live_bytes - bytes : 0;
+
+    spin_unlock_irqrestore(&g_mm_stats_lock, flags);
+}
+
+// Tür başına en çok byte isteyen MM_STATS_TOP çağrı yeri.
+// Kopya üzerinde seçim: dump sırasında kilit kısa tutulur.
+static void mm_stats_dump_kind(mm_stat_kind_t kind)
+{
+    static mm_site_t sites[MM_STATS_SITES];
+    mm_kind_stats_t k;
+
+    uint64_t flags = spin_lock_irqsave(&g_mm_stats_lock);
+    k = g_mm_kind[kind];
+    for (uint32_t i = 0; i < MM_STATS_SITES; ++i)
+        sites[i] = g_mm_sites[kind][i];
+    spin_unlock_irqrestore(&g_mm_stats_lock, flags);
+
+    fb_print("[mm_stats] ");
+    fb_print(g_mm_kind_name[kind]);
+    fb_print(": allocs=");
+    fb_print_uint(k.allocs);
+    fb_print(" frees=");
+    fb_print_uint(k.frees);
+    fb_print(" live=");
+    fb_print_uint(k.live_bytes);
+    fb_print(" peak=");
+    fb_print_uint(k.peak_bytes);
+    fb_print("\n");
+
+    fb_print("[mm_stats]   size histogram (log2 bytes: count):");
+    for (uint32_t b = 0; b < MM_STATS_HIST; ++b) {
+        if (!k.hist[b])
+            continue;
+        fb_print(" ");
+        fb_print_uint(b);
+        fb_print(":");
+        fb_print_uint(k.hist[b]);
+    }
+    fb_print("\n");
+
+    for (uint32_t n = 0; n < MM_STATS_TOP; ++n) {
+        mm_site_t *best = NULL;
+        for (uint32_t i = 0; i < MM_STATS_SITES; ++i) {
+            mm_site_t *s = &sites[i];
+            if (s->site && (!best || s->bytes > best->bytes))
+                best = s;
+        }
+        if (!best)
+            break;
+
+        fb_print("[mm_stats]   site ");
+        fb_print_hex(best->site);
+        fb_print(" allocs=");
+        fb_print_uint(best->allocs);
+        fb_print(" bytes=");
+        fb_print_uint(best->bytes);
+        fb_print("\n");
+        best->site = 0;
+    }
+
+    if (k.other_allocs) {
+        fb_print("[mm_stats]   other allocs=");
+        fb_print_uint(k.other_allocs);
+        fb_print("\n");
+    }
+}
+
+#endif // AYKEN_MM_STATS
+
+
+// ============================================================================
+//  mm_stats_dump
+// ============================================================================
+
+void mm_stats_dump(void)
+{
+    uint64_t total = phys_get_total_frames();
+    uint64_t free  = phys_get_free_frames();
+
+    fb_print("[mm_stats] frames: total=");
+    fb_print_uint(total);
+    fb_print(" free=");
+    fb_print_uint(free);
+    fb_print(" zero_pool=");
+    fb_print_uint(phys_zero_pool_count());
+    fb_print("\n");
+
+    // Fragmentasyon: boş alanın en büyük bloğun dışında kalan yüzdesi
+    kheap_stats_t hs;
+    kheap_get_stats(&hs);
+
+    uint64_t frag = hs.free_bytes ?
+        100 - (hs.largest_free * 100) / hs.free_bytes : 0;
+
+    fb_print("[mm_stats] kheap: mapped=");
+    fb_print_uint(hs.mapped_bytes);
+    fb_print(" free=");
+    fb_print_uint(hs.free_bytes);
+    fb_print(" blocks=");
+    fb_print_uint(hs.free_blocks);
+    fb_print(" largest=");
+    fb_print_uint(hs.largest_free);
+    fb_print(" frag=");
+    fb_print_uint(frag);
+    fb_print("%\n");
+
+#if AYKEN_MM_STATS
+    for (uint32_t k = 0; k < MM_STAT_KINDS; ++k)
+        mm_stats_dump_kind((mm_stat_kind_t)k);
+#else
+    fb_print("[mm_stats] per-site counters disabled (AYKEN_MM_STATS=0).\n");
+#endif
+}
@@ -0,0 +1,175 @@
+// kernel/mm/page_zero.c
+// ============================================================================
+//  AykenOS Sıfırlanmış Frame Havuzu (pre-zeroed page pool)
+//
+//  - Page table, user image ve user stack frame'leri sıfırlanmış olarak
+//    istenir; bunu ayırma anında senkron yapmak process oluşturma ve
+//    page table kurulumunun kritik yolunu uzatıyor.
+//  - Havuz, idle öncelikli bir kernel thread'i tarafından (başka iş
+//    yokken) doldurulur. Sıfırlama non-temporal store (movnti) ile
+//    yapılır; böylece 4 KB'lık yazma cache'i kirletmez.
+//  - phys_alloc_zeroed_frame() önce havuza bakar; havuz boşsa frame'i
+//    klasik yoldan alıp senkron sıfırlar (rep stosq, cache'e sıcak kalır).
+//  - sched_yield, ready kuyruğu boşken idle thread'e geçer; worker her
+//    frame'den sonra yield eder, böylece hazır iş hiç beklemez. Havuz
+//    dolunca (ya da bellek yokken) sti; hlt ile bir sonraki kesmeyi bekler.
+//  - AYKEN_ZERO_POOL_FRAMES (ayken.h) 0 yapılırsa havuz devre dışı kalır;
+//    worker yalnızca hlt'de bekleyen idle thread olarak çalışır.
+// ============================================================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../include/mm.h"
+#include "../include/ayken.h"
+#include "../drivers/console/fb_console.h"
+#include "../arch/x86_64/cpu.h"
+#include "../arch/x86_64/spinlock.h"
+#include "../sched/sched.h"
+
+#if AYKEN_ZERO_POOL_FRAMES > 0
+static uint64_t   g_zero_pool[AYKEN_ZERO_POOL_FRAMES];
+#endif
+static uint32_t   g_zero_count = 0;
+static spinlock_t g_zero_lock  = SPINLOCK_INIT;
+
+// İstatistik: havuzdan karşılanan / senkron sıfırlanan istek sayısı
+static uint64_t g_zero_hits   = 0;
+static uint64_t g_zero_misses = 0;
+
+
+// ============================================================================
+//  Sıfırlama yardımcıları
+// ============================================================================
+
+// Kritik yoldaki sıfırlama: çağıran frame'e hemen yazacağı için
+// cache'e sıcak bırakmak istiyoruz.
+static inline void page_zero_sync(void *dst)
+{
+    uint64_t cnt = AYKEN_FRAME_SIZE / 8;
+    __asm__ volatile("rep stosq"
+                     : "+D"(dst), "+c"(cnt)
+                     : "a"(0ULL)
+                     : "memory");
+}
+
+// Arka plan sıfırlaması: movnti write-combining buffer üzerinden doğrudan
+// belleğe yazar, cache satırlarını tahsis etmez. Sonda sfence ile
+// store'ların görünür olması garanti edilir.
+static inline void page_zero_nt(void *dst)
+{
+    uint64_t *p = (uint64_t *)dst;
+
+    for (uint64_t i = 0; i < AYKEN_FRAME_SIZE / 8; i += 8) {
+        __asm__ volatile(
+            "movnti %1,  0(%0)\n\t"
+            "movnti %1,  8(%0)\n\t"
+            "movnti %1, 16(%0)\n\t"
+            "movnti %1, 24(%0)\n\t"
+            "movnti %1, 32(%0)\n\t"
+            "movnti %1, 40(%0)\n\t"
+            "movnti %1, 48(%0)\n\t"
+            "movnti %1, 56(%0)\n\t"
+            :: "r"(p + i), "r"(0ULL)
+            : "memory");
+    }
+
+    __asm__ volatile("sfence" ::: "memory");
+}
+
+
+// ============================================================================
+//  Havuz doldurma (idle thread)
+// ============================================================================
+
+// Havuza bir frame ekler. Havuz dolu ya da bellek yoksa 0 döner.
+static int zero_pool_fill_one(void)
+{
+#if AYKEN_ZERO_POOL_FRAMES > 0
+    // Kilit almadan kaba kontrol; kesin kontrol push sırasında
+    if (__atomic_load_n(&g_zero_count, __ATOMIC_RELAXED) >= AYKEN_ZERO_POOL_FRAMES)
+        return 0;
+
+    uint64_t phys = phys_alloc_frame();
+    if (!phys)
+        return 0;
+
+    page_zero_nt(paging_phys_to_virt(phys));
+
+    uint64_t flags = spin_lock_irqsave(&g_zero_lock);
+    if (g_zero_count < AYKEN_ZERO_POOL_FRAMES) {
+        g_zero_pool[g_zero_count++] = phys;
+        phys = 0;
+    }
+    spin_unlock_irqrestore(&g_zero_lock, flags);
+
+    // Bu arada başka biri havuzu doldurduysa frame'i geri ver
+    if (phys) {
+        phys_free_frame(phys);
+        return 0;
+    }
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+void phys_zero_pool_worker(void)
+{
+    fb_print("[phys_mem] zero pool worker running.\n");
+
+    for (;;) {
+        // Her turda bir frame: ready kuyruğunda iş varsa hemen bırak
+        if (zero_pool_fill_one()) {
+            sched_yield();
+            continue;
+        }
+
+        // Havuz dolu ya da bellek yok: ready kuyruğu kesmeler kapalıyken
+        // kontrol edilir; sti'nin gölgesi sayesinde arada bekleyen kesme
+        // de hlt'yi uyandırır. Timer ISR iş varsa oradan geçiş yapar.
+        disable_interrupts();
+        sched_yield();
+        __asm__ volatile("sti; hlt" ::: "memory");
+    }
+}
+
+
+// ============================================================================
+//  phys_alloc_zeroed_frame
+// ============================================================================
+
+uint64_t phys_alloc_zeroed_frame(void)
+{
+    // Telemetride frame'in sahibi bizi çağıran (page table, vm, ...)
+    void *site = MM_STATS_CALLER;
+    (void)site;
+
+#if AYKEN_ZERO_POOL_FRAMES > 0
+    uint64_t phys = 0;
+
+    uint64_t flags = spin_lock_irqsave(&g_zero_lock);
+    if (g_zero_count)
+        phys = g_zero_pool[--g_zero_count];
+    spin_unlock_irqrestore(&g_zero_lock, flags);
+
+    if (phys) {
+        // Ayırma doldurma sırasında sayıldı; burada yalnızca sahibi
+        MM_STATS_SITE(MM_STAT_FRAME, site, AYKEN_FRAME_SIZE);
+        __atomic_fetch_add(&g_zero_hits, 1, __ATOMIC_RELAXED);
+        return phys;
+    }
+#endif
+
+    uint64_t frame = phys_alloc_frame_at(site);
+    if (!frame)
+        return 0;
+
+    page_zero_sync(paging_phys_to_virt(frame));
+    __atomic_fetch_add(&g_zero_misses, 1, __ATOMIC_RELAXED);
+    return frame;
+}
+
+uint64_t phys_zero_pool_count(void)
+{
+    return __atomic_load_n(&g_zero_count, __ATOMIC_RELAXED);
+}
@@ -6,20 +6,32 @@
 //  - CR3 kaydını yükler
 //  - Yeni page table (PML4/PDPT/PD/PT) ayırır
 //  - 4KB sayfa bazlı map / unmap işlemleri sağlar
+//  - 2MB (PDE.PS) ve 1GB (PDPTE.PS) büyük sayfalar: paging_map_huge /
+//    paging_map_region; hizalama uymazsa 4KB'a düşülür
 //
 //  Tasarım Notları:
-//   * Şimdilik sadece 4KB sayfa kullanıyoruz (huge page yok).
+//   * Büyük sayfanın içindeki tek bir 4KB sayfa map/unmap edilirse giriş
+//     aynı çeviriyi veren bir alt tabloya bölünür (split).
+//   * paging_get_phys büyük sayfalarda da ilgili 4KB frame'in adresini döner.
 //   * Tüm page table'lar fiziksel olarak 4KB frame içinde tutuluyor.
-//   * Page table bellekleri phys_alloc_frame() ile ayrılıyor.
-//   * Page table’lara erişim için higher-half mapping varsayımı:
-//       virt = phys + KERNEL_VIRT_BASE
-//     (Bootloader bu mapping’i kurmuş olmalı.)
+//   * Page table bellekleri phys_alloc_zeroed_frame() ile ayrılıyor;
+//     boşalan tablolar küçük bir cache'e döner ve önce oradan verilir.
+//   * Her tablonun present giriş sayısı frame'in aux sayacında tutulur;
+//     unmap'te sayacı 0'a inen PT/PD/PDPT serbest bırakılır.
+//   * Page table’lara erişim direct map üzerinden:
+//       virt = phys + DIRECT_MAP_BASE
+//     paging_init tüm RAM'i büyük sayfalarla oraya map edene kadar
+//     bootloader'ın higher-half penceresi (phys + KERNEL_VIRT_BASE,
+//     ilk 2 GiB) kullanılır.
 // ============================================================================
 
 #include <stdint.h>
+#include <stddef.h>
 #include "../include/mm.h"
 #include "../include/ayken.h"
 #include "../drivers/console/fb_console.h"
+#include "../arch/x86_64/cpu.h"
+#include "../arch/x86_64/spinlock.h"
 
 // ---------------------------------------------------------------------------
 // x86_64 page table sabitleri ve flag'ler
@@ -33,21 +45,24 @@ typedef uint64_t ayken_pte_t;
 #define AYKEN_PTE_PRESENT         (1ULL << 0)
 #define AYKEN_PTE_WRITABLE        (1ULL << 1)
 #define AYKEN_PTE_USER            (1ULL << 2)
+#define AYKEN_PTE_GLOBAL          (1ULL << 8)
+#define AYKEN_PTE_ADDR_MASK       0x000FFFFFFFFFF000ULL
+#endif
+
+// mm.h yalnızca temel bitleri tanımlıyor; geri kalanlar burada.
 #define AYKEN_PTE_WRITE_THROUGH   (1ULL << 3)
 #define AYKEN_PTE_CACHE_DISABLE   (1ULL << 4)
 #define AYKEN_PTE_ACCESSED        (1ULL << 5)
 #define AYKEN_PTE_DIRTY           (1ULL << 6)
-#define AYKEN_PTE_HUGE            (1ULL << 7)
-#define AYKEN_PTE_GLOBAL          (1ULL << 8)
+#define AYKEN_PTE_HUGE            (1ULL << 7)     // PDE/PDPTE: PS
+#define AYKEN_PTE_PAT             (1ULL << 7)     // 4KB PTE: PAT
+#define AYKEN_PTE_LARGE_PAT       (1ULL << 12)    // PS'li girişte PAT
+#define AYKEN_PTE_COW             (1ULL << 9)     // AVL: COW ile paylaşılan sayfa
 
 // Tablo pointer'ları için kullanacağımız flags:
 // Present + Writable (kernel space tablolar için yeterli)
 #define AYKEN_PTE_TABLE_FLAGS     (AYKEN_PTE_PRESENT | AYKEN_PTE_WRITABLE)
 
-// Kernel page’leri için temel flag seti:
-#define AYKEN_PTE_ADDR_MASK       0x000FFFFFFFFFF000ULL
-#endif
-
 #define AYKEN_PTE_KERNEL_FLAGS    (AYKEN_PTE_PRESENT | AYKEN_PTE_WRITABLE | AYKEN_PTE_GLOBAL)
 
 // Adresi entry'den çekmek için maske
@@ -73,17 +88,32 @@ typedef uint64_t ayken_pte_t;
 static uint64_t   g_kernel_pml4_phys = 0;
 static ayken_pte_t *g_kernel_pml4    = NULL;
 
-// Higher-half mapping varsayımı:
-//   virt = phys + KERNEL_VIRT_BASE
-// Bootloader bu mapping'i kurmuş olmalı.
+// CPU 1GB sayfaları destekliyor mu (paging_init'te CPUID'den)
+static int        g_paging_1g = 0;
+
+// CR4.PCIDE açıldı mı (paging_init'te CPUID'den)
+static int        g_paging_pcid = 0;
+
+// IA32_PAT programlandı mı (PA4 = WC)
+static int        g_paging_pat = 0;
+
+// Paylaşılan salt okunur sıfır frame'i (bkz. paging_zero_frame). Kalıcıdır
+// ve referans sayılmaz: map/paylaşım/unmap sayacına hiç dokunmaz.
+static uint64_t   g_zero_frame = 0;
+
+// Fiziksel bellek penceresi: boot'ta bootloader'ın higher-half map'i
+// (virt = phys + KERNEL_VIRT_BASE), direct map kurulunca DIRECT_MAP_BASE.
+// Eski pencere map'li kalır; daha önce alınmış pointer'lar geçerli.
+static uint64_t   g_phys_virt_base = KERNEL_VIRT_BASE;
+
 static inline void *phys_to_virt(uint64_t phys)
 {
-    return (void *)(phys + KERNEL_VIRT_BASE);
+    return (void *)(phys + g_phys_virt_base);
 }
 
 static inline uint64_t virt_to_phys(const void *virt)
 {
-    return ((uint64_t)virt - KERNEL_VIRT_BASE);
+    return ((uint64_t)virt - g_phys_virt_base);
 }
 
 void *paging_phys_to_virt(uint64_t phys)
@@ -102,6 +132,309 @@ void paging_load_cr3(uint64_t phys_addr)
     load_cr3(phys_addr);
 }
 
+static void tlb_flush_all(void);
+
+// ---------------------------------------------------------------------------
+// PCID: adres alanı başına TLB etiketi. 1..PAGING_PCID_COUNT-1 sırayla
+// dağıtılır; bir nesil içinde hiçbir PCID iki adres alanına verilmez.
+// Tükenince nesil artar ve TLB tamamen temizlenir: eski nesildeki
+// etiketler geçersizleşir, sahipleri bir sonraki geçişte yenisini alır.
+// Kernel girişleri global olduğundan tüm PCID'lerde invlpg ile gider.
+// ---------------------------------------------------------------------------
+
+#define CR0_WP                  (1ULL << 16)
+#define CR4_PCIDE               (1ULL << 17)
+#define CR3_NOFLUSH             (1ULL << 63)
+#define PAGING_PCID_COUNT       4096
+
+static spinlock_t g_pcid_lock = SPINLOCK_INIT;
+static uint32_t   g_pcid_gen  = 1;
+static uint16_t   g_pcid_next = 1;
+
+uint64_t paging_asid_cr3(uint64_t pml4_phys, uint16_t *pcid, uint32_t *gen)
+{
+    if (!g_paging_pcid)
+        return pml4_phys;
+
+    // Kernel adres alanı sabit PCID 0: hiç geri dönüştürülmez
+    if (pml4_phys == g_kernel_pml4_phys)
+        return pml4_phys | CR3_NOFLUSH;
+
+    uint64_t flags = spin_lock_irqsave(&g_pcid_lock);
+
+    if (*gen == g_pcid_gen) {
+        uint64_t cr3 = pml4_phys | *pcid | CR3_NOFLUSH;
+        spin_unlock_irqrestore(&g_pcid_lock, flags);
+        return cr3;
+    }
+
+    if (g_pcid_next >= PAGING_PCID_COUNT) {
+        g_pcid_gen++;
+        g_pcid_next = 1;
+        tlb_flush_all();
+    }
+
+    *pcid = g_pcid_next++;
+    *gen  = g_pcid_gen;
+    spin_unlock_irqrestore(&g_pcid_lock, flags);
+
+    // İlk yükleme flush'lı: bu PCID altında kalmış hiçbir şeye güvenme
+    return pml4_phys | *pcid;
+}
+
+
+// ---------------------------------------------------------------------------
+// TLB gather: bir range işlemi boyunca geçersizlenecek adresler toplanır,
+// sonda tek seferde flush edilir. PAGING_TLB_GATHER_MAX'tan fazlası için
+// tek tek invlpg yerine tüm TLB (global girişler dahil) temizlenir.
+// Map'i kaldırılan frame'ler ve tablolar da flush bitene kadar bekler;
+// frame kuyruğu dolarsa ara flush yapılır.
+// ---------------------------------------------------------------------------
+
+#define PAGING_TLB_GATHER_MAX   32
+#define CR4_PGE                 (1ULL << 7)
+
+typedef struct {
+    uint64_t va[PAGING_TLB_GATHER_MAX];
+    uint32_t count;
+    int      global;      // kernel yarısında tablo söküldü → tüm PCID'ler
+    int      inactive;    // yüklü olmayan adres alanı: invlpg gereksiz
+    uint64_t tables;      // flush'tan sonra bırakılacak tablolar (zincir)
+    uint64_t frames[PAGING_TLB_GATHER_MAX];  // flush'tan sonra free edilecek
+    uint64_t frame_pages[PAGING_TLB_GATHER_MAX];
+    uint32_t frame_count;
+} paging_tlb_gather_t;
+
+static inline void tlb_gather_add(paging_tlb_gather_t *g, uint64_t va)
+{
+    if (g->count < PAGING_TLB_GATHER_MAX)
+        g->va[g->count] = va;
+    g->count++;
+}
+
+// Global sayfalar CR3 yeniden yüklemesiyle gitmez: CR4.PGE aç/kapa
+static void tlb_flush_all(void)
+{
+    uint64_t cr4;
+    __asm__ volatile("mov %%cr4, %0" : "=r"(cr4));
+
+    if (cr4 & CR4_PGE) {
+        __asm__ volatile("mov %0, %%cr4" :: "r"(cr4 & ~CR4_PGE) : "memory");
+        __asm__ volatile("mov %0, %%cr4" :: "r"(cr4) : "memory");
+    } else {
+        uint64_t cr3;
+        __asm__ volatile("mov %%cr3, %0" : "=r"(cr3));
+        __asm__ volatile("mov %0, %%cr3" :: "r"(cr3) : "memory");
+    }
+}
+
+static void pt_cache_put(uint64_t phys);
+
+// Map'i kaldırılan frame'ler ve sökülen tablolar: TLB'de (tablolar için
+// paging-structure cache'lerinde) çevirileri kalmış olabilir, flush
+// bitmeden yeniden kullanılmamalı.
+static void tlb_gather_release(paging_tlb_gather_t *g)
+{
+    for (uint32_t i = 0; i < g->frame_count; ++i) {
+        // 4KB frame COW ile paylaşılıyor olabilir: yalnızca bir sahip düşer
+        if (g->frame_pages[i] == 1)
+            phys_free_frame(g->frames[i]);
+        else
+            phys_free_frames(g->frames[i], g->frame_pages[i]);
+    }
+    g->frame_count = 0;
+
+    while (g->tables) {
+        uint64_t phys = g->tables;
+        ayken_pte_t *t = (ayken_pte_t *)phys_to_virt(phys);
+
+        g->tables = t[0];
+        t[0] = 0;
+
+        // Reclaim bekleyen boot bölgesindekiler reclaim ile döner
+        if (!phys_mem_is_reclaimable(phys))
+            pt_cache_put(phys);
+    }
+}
+
+static void tlb_gather_flush(paging_tlb_gather_t *g)
+{
+    if (g->count > PAGING_TLB_GATHER_MAX || g->global) {
+        // Yüklü olmayan alanda yalnızca kernel tabloları başka PCID'lerde
+        // cache'li olabilir; kendi girişleri yeni PCID'yle zaten gider.
+        if (!g->inactive || g->global)
+            tlb_flush_all();
+    } else if (!g->inactive) {
+        for (uint32_t i = 0; i < g->count; ++i)
+            __asm__ volatile("invlpg (%0)" :: "r"(g->va[i]) : "memory");
+    }
+    g->count  = 0;
+    g->global = 0;
+    tlb_gather_release(g);
+}
+
+
+// ---------------------------------------------------------------------------
+// Page table cache: boşalan tablolar sıfırlanmış halde küçük bir LIFO'da
+// bekler; yeni tablo önce buradan verilir (global allocator ve 4KB
+// sıfırlama yok). Bekleyen frame'in ilk word'ü bir sonrakini gösterir.
+// ---------------------------------------------------------------------------
+
+#define PAGING_PT_CACHE_MAX     64
+
+static spinlock_t g_pt_cache_lock  = SPINLOCK_INIT;
+static uint64_t   g_pt_cache       = 0;
+static uint32_t   g_pt_cache_count = 0;
+
+static uint64_t pt_cache_pop(void)
+{
+    uint64_t flags = spin_lock_irqsave(&g_pt_cache_lock);
+
+    uint64_t phys = g_pt_cache;
+    if (phys) {
+        ayken_pte_t *t = (ayken_pte_t *)phys_to_virt(phys);
+        g_pt_cache = t[0];
+        t[0] = 0;
+        g_pt_cache_count--;
+    }
+
+    spin_unlock_irqrestore(&g_pt_cache_lock, flags);
+    return phys;
+}
+
+// phys: tüm girişleri not-present, doluluk sayacı 0 olan tablo
+static void pt_cache_put(uint64_t phys)
+{
+    // Not-present girişlerde bit kalmış olabilir (boot tabloları)
+    ayken_pte_t *t = (ayken_pte_t *)phys_to_virt(phys);
+    for (int i = 0; i < AYKEN_PT_ENTRIES; ++i) {
+        if (t[i])
+            t[i] = 0;
+    }
+
+    uint64_t flags = spin_lock_irqsave(&g_pt_cache_lock);
+    if (g_pt_cache_count < PAGING_PT_CACHE_MAX) {
+        t[0] = g_pt_cache;
+        g_pt_cache = phys;
+        g_pt_cache_count++;
+        spin_unlock_irqrestore(&g_pt_cache_lock, flags);
+        return;
+    }
+    spin_unlock_irqrestore(&g_pt_cache_lock, flags);
+
+    phys_free_frame(phys);
+}
+
+
+// ---------------------------------------------------------------------------
+// Tablo doluluğu: her tablo frame'inin present giriş sayısı
+// phys_frame_aux'ta. Girişin present durumunu değiştiren her yazma
+// pte_set'ten geçer; sayaç 0'a inen tablo prune_tables ile sökülür.
+// ---------------------------------------------------------------------------
+
+static inline uint16_t *table_count(const ayken_pte_t *table)
+{
+    return phys_frame_aux(virt_to_phys(table));
+}
+
+static inline void pte_set(ayken_pte_t *entry, ayken_pte_t v)
+{
+    ayken_pte_t old = *entry;
+    *entry = v;
+
+    if ((old ^ v) & AYKEN_PTE_PRESENT) {
+        uint16_t *cnt = table_count((const ayken_pte_t *)
+                                    ((uint64_t)entry & ~(AYKEN_FRAME_SIZE - 1)));
+        if (cnt) {
+            if (v & AYKEN_PTE_PRESENT)
+                (*cnt)++;
+            else
+                (*cnt)--;
+        }
+    }
+}
+
+static int table_is_empty(const ayken_pte_t *t)
+{
+    for (int i = 0; i < AYKEN_PT_ENTRIES; ++i) {
+        if (t[i] & AYKEN_PTE_PRESENT)
+            return 0;
+    }
+    return 1;
+}
+
+// Boot tabloları: sayaçlar mevcut içerikten kurulur
+static void table_count_init(uint64_t phys, void *ctx)
+{
+    (void)ctx;
+
+    uint16_t *cnt = phys_frame_aux(phys);
+    if (!cnt)
+        return;
+
+    const ayken_pte_t *t = (const ayken_pte_t *)phys_to_virt(phys);
+    uint16_t n = 0;
+    for (int i = 0; i < AYKEN_PT_ENTRIES; ++i) {
+        if (t[i] & AYKEN_PTE_PRESENT)
+            n++;
+    }
+    *cnt = n;
+}
+
+// entry'nin gösterdiği tablo boşsa girişi siler ve tabloyu gather'a
+// bırakır. va: tablonun kapsadığı herhangi bir adres.
+static int table_release(ayken_pte_t *entry, uint64_t va, paging_tlb_gather_t *g)
+{
+    uint64_t phys = *entry & AYKEN_PTE_ADDR_MASK;
+    uint16_t *cnt = phys_frame_aux(phys);
+    if (!cnt || *cnt)
+        return 0;
+
+    // Sayaç 0: söküm nadir, taramayla teyit et
+    ayken_pte_t *t = (ayken_pte_t *)phys_to_virt(phys);
+    if (!table_is_empty(t))
+        return 0;
+
+    pte_set(entry, 0);
+
+    // Kernel tabloları tüm adres alanlarında (her PCID'de) cache'li olabilir
+    if (PML4_INDEX(va) >= AYKEN_PT_ENTRIES / 2)
+        g->global = 1;
+    else
+        tlb_gather_add(g, va);
+
+    // Zincir işaretçisi present biti taşımaz: eski yürüyüşler bir şey bulmaz
+    t[0] = g->tables;
+    g->tables = phys;
+    return 1;
+}
+
+// va'yı kapsayan yol üzerinde boşalan PT → PD → PDPT'yi söker.
+// Kök hiç sökülmez; kernel yarısının PDPT'leri de kalıcıdır (user
+// PML4'leri bu girişlerin kopyasını taşır).
+static void prune_tables(ayken_pte_t *root, uint64_t va, paging_tlb_gather_t *g)
+{
+    ayken_pte_t *pml4e = &root[PML4_INDEX(va)];
+    if (!(*pml4e & AYKEN_PTE_PRESENT))
+        return;
+    ayken_pte_t *pdpt = (ayken_pte_t *)phys_to_virt(*pml4e & AYKEN_PTE_ADDR_MASK);
+
+    ayken_pte_t *pdpte = &pdpt[PDPT_INDEX(va)];
+    if ((*pdpte & (AYKEN_PTE_PRESENT | AYKEN_PTE_HUGE)) == AYKEN_PTE_PRESENT) {
+        ayken_pte_t *pd  = (ayken_pte_t *)phys_to_virt(*pdpte & AYKEN_PTE_ADDR_MASK);
+        ayken_pte_t *pde = &pd[PD_INDEX(va)];
+
+        if ((*pde & (AYKEN_PTE_PRESENT | AYKEN_PTE_HUGE)) == AYKEN_PTE_PRESENT &&
+            !table_release(pde, va, g))
+            return;
+        if (!table_release(pdpte, va, g))
+            return;
+    }
+
+    if (PML4_INDEX(va) < AYKEN_PT_ENTRIES / 2)
+        table_release(pml4e, va, g);
+}
+
 
 // ============================================================================
 //  Yeni page table ayırma (4KB)
@@ -109,18 +442,18 @@ void paging_load_cr3(uint64_t phys_addr)
 
 uint64_t paging_alloc_page_table(void)
 {
-    uint64_t phys = phys_alloc_frame();
+    // Önce sökülmüş tablolardan, sonra sıfırlanmış havuzdan:
+    // tüm girişler zaten 0 (not present)
+    uint64_t phys = pt_cache_pop();
+    if (phys)
+        return phys;
+
+    phys = phys_alloc_zeroed_frame();
     if (phys == 0) {
-        fb_print("[AykenOS][paging] ERROR: phys_alloc_frame() failed for page table.\n");
+        fb_print("[AykenOS][paging] ERROR: phys_alloc_zeroed_frame() failed for page table.\n");
         return 0;
     }
 
-    ayken_pte_t *tbl = (ayken_pte_t *)phys_to_virt(phys);
-
-    // Tüm girişleri temizle
-    for (int i = 0; i < AYKEN_PT_ENTRIES; ++i)
-        tbl[i] = 0;
-
     return phys;
 }
 
@@ -147,7 +480,7 @@ static ayken_pte_t *get_or_create_table(ayken_pte_t *table,
         }
 
         // Entry'ye yaz: adres + flags
-        table[index] = (phys & AYKEN_PTE_ADDR_MASK) | table_flags;
+        pte_set(&table[index], (phys & AYKEN_PTE_ADDR_MASK) | table_flags);
     }
 
     uint64_t next_phys = table[index] & AYKEN_PTE_ADDR_MASK;
@@ -155,6 +488,123 @@ static ayken_pte_t *get_or_create_table(ayken_pte_t *table,
 }
 
 
+// ============================================================================
+//  Büyük sayfa yardımcıları
+// ============================================================================
+
+// Leaf girişin yazılacağı flag'ler (4KB ve büyük sayfa ortak)
+static inline uint64_t leaf_flags(uint64_t flags)
+{
+    uint64_t entry_flags = AYKEN_PTE_PRESENT | AYKEN_PTE_WRITABLE;
+    if (flags & AYKEN_PTE_USER)
+        entry_flags |= AYKEN_PTE_USER;
+    else
+        entry_flags |= AYKEN_PTE_GLOBAL;
+
+    return entry_flags | (flags & ~(AYKEN_PTE_USER));
+}
+
+// PS'li bir PDPTE/PDE'yi aynı çeviriyi veren bir alt tabloya böler.
+// page_size: girişin kapsadığı boyut (1GB → 512 x 2MB, 2MB → 512 x 4KB).
+static int split_huge_entry(ayken_pte_t *entry, uint64_t page_size)
+{
+    ayken_pte_t e = *entry;
+
+    uint64_t table_phys = paging_alloc_page_table();
+    if (!table_phys) {
+        fb_print("[AykenOS][paging] ERROR: cannot split huge page.\n");
+        return -1;
+    }
+
+    ayken_pte_t *t   = (ayken_pte_t *)phys_to_virt(table_phys);
+    uint64_t base    = e & AYKEN_PTE_ADDR_MASK & ~(page_size - 1);
+    uint64_t attrs   = e & ~AYKEN_PTE_ADDR_MASK;
+    uint64_t sub     = page_size / AYKEN_PT_ENTRIES;
+    uint64_t child;
+
+    if (sub == AYKEN_FRAME_SIZE) {
+        // 4KB PTE'de PS yok, PAT biti 12'den 7'ye taşınır
+        child = attrs & ~AYKEN_PTE_HUGE;
+        if (e & AYKEN_PTE_LARGE_PAT)
+            child |= AYKEN_PTE_PAT;
+    } else {
+        child = attrs | (e & AYKEN_PTE_LARGE_PAT);
+    }
+
+    for (uint64_t i = 0; i < AYKEN_PT_ENTRIES; ++i)
+        t[i] = (base + i * sub) | child;
+
+    uint16_t *cnt = table_count(t);
+    if (cnt)
+        *cnt = AYKEN_PT_ENTRIES;
+
+    *entry = table_phys | AYKEN_PTE_TABLE_FLAGS | (e & AYKEN_PTE_USER);
+    return 0;
+}
+
+// virt'in leaf girişi (PS'li PDPTE/PDE ya da PTE); map yoksa NULL.
+// *page_size leaf'in kapsadığı boyutu alır.
+static ayken_pte_t *paging_walk(ayken_pte_t *root, uint64_t virt,
+                                uint64_t *page_size)
+{
+    ayken_pte_t pml4e = root[PML4_INDEX(virt)];
+    if (!(pml4e & AYKEN_PTE_PRESENT)) return NULL;
+    ayken_pte_t *pdpt = (ayken_pte_t *)phys_to_virt(pml4e & AYKEN_PTE_ADDR_MASK);
+
+    ayken_pte_t *pdpte = &pdpt[PDPT_INDEX(virt)];
+    if (!(*pdpte & AYKEN_PTE_PRESENT)) return NULL;
+    if (*pdpte & AYKEN_PTE_HUGE) {
+        *page_size = AYKEN_PAGE_SIZE_1G;
+        return pdpte;
+    }
+    ayken_pte_t *pd = (ayken_pte_t *)phys_to_virt(*pdpte & AYKEN_PTE_ADDR_MASK);
+
+    ayken_pte_t *pde = &pd[PD_INDEX(virt)];
+    if (!(*pde & AYKEN_PTE_PRESENT)) return NULL;
+    if (*pde & AYKEN_PTE_HUGE) {
+        *page_size = AYKEN_PAGE_SIZE_2M;
+        return pde;
+    }
+    ayken_pte_t *pt = (ayken_pte_t *)phys_to_virt(*pde & AYKEN_PTE_ADDR_MASK);
+
+    ayken_pte_t *pte = &pt[PT_INDEX(virt)];
+    if (!(*pte & AYKEN_PTE_PRESENT)) return NULL;
+
+    *page_size = AYKEN_FRAME_SIZE;
+    return pte;
+}
+
+// Tablo yolu üzerinde virt'i kapsayan büyük girişler varsa böl
+static int split_to_table(ayken_pte_t *entry, uint64_t page_size)
+{
+    if ((*entry & (AYKEN_PTE_PRESENT | AYKEN_PTE_HUGE)) ==
+        (AYKEN_PTE_PRESENT | AYKEN_PTE_HUGE))
+        return split_huge_entry(entry, page_size);
+    return 0;
+}
+
+
+// virt'i kapsayan PT'yi döner; yol üzerindeki tabloları oluşturur,
+// büyük sayfaları böler. flags'te USER varsa ara tablolar da USER olur.
+static ayken_pte_t *get_or_create_pt(ayken_pte_t *root, uint64_t virt,
+                                     uint64_t flags)
+{
+    uint64_t table_flags = AYKEN_PTE_TABLE_FLAGS;
+    if (flags & AYKEN_PTE_USER)
+        table_flags |= AYKEN_PTE_USER;
+
+    ayken_pte_t *pdpt = get_or_create_table(root, PML4_INDEX(virt), table_flags);
+    if (!pdpt) return NULL;
+
+    if (split_to_table(&pdpt[PDPT_INDEX(virt)], AYKEN_PAGE_SIZE_1G) != 0) return NULL;
+    ayken_pte_t *pd = get_or_create_table(pdpt, PDPT_INDEX(virt), table_flags);
+    if (!pd) return NULL;
+
+    if (split_to_table(&pd[PD_INDEX(virt)], AYKEN_PAGE_SIZE_2M) != 0) return NULL;
+    return get_or_create_table(pd, PD_INDEX(virt), table_flags);
+}
+
+
 // ============================================================================
 //  paging_map_page
 //
@@ -175,33 +625,10 @@ static void paging_map_page_into_root(ayken_pte_t *root,
         return;
     }
 
-    uint16_t i_pml4 = PML4_INDEX(virt_addr);
-    uint16_t i_pdpt = PDPT_INDEX(virt_addr);
-    uint16_t i_pd   = PD_INDEX(virt_addr);
-    uint16_t i_pt   = PT_INDEX(virt_addr);
-
-    uint64_t table_flags = AYKEN_PTE_TABLE_FLAGS;
-    if (flags & AYKEN_PTE_USER)
-        table_flags |= AYKEN_PTE_USER;
-
-    ayken_pte_t *pdpt = get_or_create_table(root, i_pml4, table_flags);
-    if (!pdpt) return;
-
-    ayken_pte_t *pd = get_or_create_table(pdpt, i_pdpt, table_flags);
-    if (!pd) return;
-
-    ayken_pte_t *pt = get_or_create_table(pd, i_pd, table_flags);
+    ayken_pte_t *pt = get_or_create_pt(root, virt_addr, flags);
     if (!pt) return;
 
-    uint64_t entry_flags = AYKEN_PTE_PRESENT | AYKEN_PTE_WRITABLE;
-    if (flags & AYKEN_PTE_USER)
-        entry_flags |= AYKEN_PTE_USER;
-    else
-        entry_flags |= AYKEN_PTE_GLOBAL;
-
-    entry_flags |= (flags & ~(AYKEN_PTE_USER));
-
-    pt[i_pt] = (phys_addr & AYKEN_PTE_ADDR_MASK) | entry_flags;
+    pte_set(&pt[PT_INDEX(virt_addr)], (phys_addr & AYKEN_PTE_ADDR_MASK) | leaf_flags(flags));
 }
 
 void paging_map_page(uint64_t virt_addr, uint64_t phys_addr, uint64_t flags)
@@ -224,6 +651,184 @@ void paging_map_page_in_pml4(uint64_t pml4_phys,
 }
 
 
+// ============================================================================
+//  paging_map_huge / paging_map_region
+//
+//  page_size = AYKEN_PAGE_SIZE_2M ya da AYKEN_PAGE_SIZE_1G; virt ve phys
+//  bu boyuta hizalı olmalı. Hedef slotun altında zaten bir page table
+//  varsa (4KB map'ler) büyük sayfa kurulmaz, -1 döner.
+// ============================================================================
+
+static int paging_map_huge_into_root(ayken_pte_t *root,
+                                     uint64_t virt_addr,
+                                     uint64_t phys_addr,
+                                     uint64_t page_size,
+                                     uint64_t flags)
+{
+    if (page_size == AYKEN_PAGE_SIZE_1G) {
+        if (!g_paging_1g)
+            return -1;
+    } else if (page_size != AYKEN_PAGE_SIZE_2M) {
+        return -1;
+    }
+
+    if ((virt_addr | phys_addr) & (page_size - 1))
+        return -1;
+
+    uint64_t table_flags = AYKEN_PTE_TABLE_FLAGS;
+    if (flags & AYKEN_PTE_USER)
+        table_flags |= AYKEN_PTE_USER;
+
+    ayken_pte_t *pdpt = get_or_create_table(root, PML4_INDEX(virt_addr), table_flags);
+    if (!pdpt) return -1;
+
+    ayken_pte_t *entry = &pdpt[PDPT_INDEX(virt_addr)];
+
+    if (page_size == AYKEN_PAGE_SIZE_2M) {
+        if (split_to_table(entry, AYKEN_PAGE_SIZE_1G) != 0) return -1;
+        ayken_pte_t *pd = get_or_create_table(pdpt, PDPT_INDEX(virt_addr), table_flags);
+        if (!pd) return -1;
+        entry = &pd[PD_INDEX(virt_addr)];
+    }
+
+    // Altında tablo var: tabloyu sessizce yetim bırakmak yerine reddet
+    if ((*entry & AYKEN_PTE_PRESENT) && !(*entry & AYKEN_PTE_HUGE))
+        return -1;
+
+    int replace = (*entry & AYKEN_PTE_PRESENT) != 0;
+
+    pte_set(entry, (phys_addr & AYKEN_PTE_ADDR_MASK) | AYKEN_PTE_HUGE |
+                   leaf_flags(flags & ~AYKEN_PTE_HUGE));
+
+    if (replace)
+        __asm__ volatile("invlpg (%0)" :: "r"(virt_addr) : "memory");
+    return 0;
+}
+
+int paging_map_huge(uint64_t virt_addr, uint64_t phys_addr,
+                    uint64_t page_size, uint64_t flags)
+{
+    if (!g_kernel_pml4) {
+        fb_print("[AykenOS][paging] ERROR: paging_init() not called.\n");
+        return -1;
+    }
+
+    return paging_map_huge_into_root(g_kernel_pml4, virt_addr, phys_addr,
+                                     page_size, flags);
+}
+
+// Bellek tipinin PTE bitleri: PAT indeksi PWT/PCD/PAT'a dağıtılır.
+// PAT biti 4KB PTE'de 7, PS'li girişte 12.
+static inline uint64_t cache_bits(paging_cache_t type, uint64_t page_size)
+{
+    uint64_t bits = 0;
+    if (type & 1)
+        bits |= AYKEN_PTE_WRITE_THROUGH;
+    if (type & 2)
+        bits |= AYKEN_PTE_CACHE_DISABLE;
+    if (type & 4)
+        bits |= page_size == AYKEN_FRAME_SIZE ? AYKEN_PTE_PAT : AYKEN_PTE_LARGE_PAT;
+    return bits;
+}
+
+static void map_region_cached(uint64_t virt_addr, uint64_t phys_addr,
+                              uint64_t size, uint64_t flags,
+                              paging_cache_t type)
+{
+    uint64_t off = 0;
+
+    while (off < size) {
+        uint64_t va   = virt_addr + off;
+        uint64_t pa   = phys_addr + off;
+        uint64_t left = size - off;
+        uint64_t step = AYKEN_FRAME_SIZE;
+
+        if (g_paging_1g && left >= AYKEN_PAGE_SIZE_1G &&
+            !((va | pa) & (AYKEN_PAGE_SIZE_1G - 1)) &&
+            paging_map_huge(va, pa, AYKEN_PAGE_SIZE_1G,
+                            flags | cache_bits(type, AYKEN_PAGE_SIZE_1G)) == 0) {
+            step = AYKEN_PAGE_SIZE_1G;
+        } else if (left >= AYKEN_PAGE_SIZE_2M &&
+                   !((va | pa) & (AYKEN_PAGE_SIZE_2M - 1)) &&
+                   paging_map_huge(va, pa, AYKEN_PAGE_SIZE_2M,
+                                   flags | cache_bits(type, AYKEN_PAGE_SIZE_2M)) == 0) {
+            step = AYKEN_PAGE_SIZE_2M;
+        } else {
+            paging_map_page(va, pa, flags | cache_bits(type, AYKEN_FRAME_SIZE));
+        }
+
+        off += step;
+    }
+}
+
+// Fiziksel olarak ardışık [phys, phys+size) bölgesini virt'e map eder:
+// her adımda hizalamanın ve kalan boyutun izin verdiği en büyük sayfa.
+void paging_map_region(uint64_t virt_addr, uint64_t phys_addr,
+                       uint64_t size, uint64_t flags)
+{
+    map_region_cached(virt_addr, phys_addr, size, flags, PAGING_CACHE_WB);
+}
+
+
+// ============================================================================
+//  paging_map_io
+//
+//  KIO penceresi bump pointer ile tüketilir. Sanal adres fiziksel adresle
+//  2MB modülünde eşlenir; böylece hizalı bölümler büyük sayfa alır.
+// ============================================================================
+
+static spinlock_t g_kio_lock = SPINLOCK_INIT;
+static uint64_t   g_kio_next = KIO_START;
+
+void *paging_map_io(uint64_t phys, uint64_t size, paging_cache_t type)
+{
+    if (!g_kernel_pml4 || size == 0)
+        return NULL;
+
+    // PAT yoksa PAT biti anlamsız: WC'nin en yakın güvenli karşılığı
+    if (type == PAGING_CACHE_WC && !g_paging_pat)
+        type = PAGING_CACHE_UC_MINUS;
+
+    uint64_t offset = phys & (AYKEN_FRAME_SIZE - 1);
+    uint64_t base   = phys - offset;
+    uint64_t len    = (size + offset + AYKEN_FRAME_SIZE - 1) & ~(AYKEN_FRAME_SIZE - 1);
+    uint64_t align  = len >= AYKEN_PAGE_SIZE_2M ? AYKEN_PAGE_SIZE_2M : AYKEN_FRAME_SIZE;
+
+    uint64_t flags = spin_lock_irqsave(&g_kio_lock);
+    uint64_t virt  = ((g_kio_next + align - 1) & ~(align - 1)) + (base & (align - 1));
+    if (virt + len > KIO_START + KIO_WINDOW_SIZE) {
+        spin_unlock_irqrestore(&g_kio_lock, flags);
+        fb_print("[AykenOS][paging] ERROR: KIO window exhausted.\n");
+        return NULL;
+    }
+    g_kio_next = virt + len;
+    spin_unlock_irqrestore(&g_kio_lock, flags);
+
+    map_region_cached(virt, base, len, 0, type);
+    return (void *)(virt + offset);
+}
+
+
+// ============================================================================
+//  paging_reserve_kernel_slot
+//
+//  Kernel yarısındaki bir PML4 girişini (ve altındaki PDPT'yi) önceden
+//  oluşturur. paging_create_user_pml4() kernel girişlerini kopyaladığı
+//  için, bölge sonradan lazy map edilse bile tüm adres alanları aynı
+//  PDPT'yi paylaşır ve yeni map'ler her yerde görünür.
+// ============================================================================
+
+void paging_reserve_kernel_slot(uint64_t virt)
+{
+    if (!g_kernel_pml4) {
+        fb_print("[AykenOS][paging] ERROR: paging_init() not called.\n");
+        return;
+    }
+
+    get_or_create_table(g_kernel_pml4, PML4_INDEX(virt), AYKEN_PTE_TABLE_FLAGS);
+}
+
+
 // ============================================================================
 //  Eski API ile uyum: paging_map
 //
@@ -241,9 +846,8 @@ void paging_map(uint64_t virt, uint64_t phys, uint64_t flags)
 // ============================================================================
 //  paging_unmap
 //
-//  Verilen sanal adres için PT entry'yi sıfırlar,
-//  ardından TLB flush (invlpg) yapar.
-//  Şimdilik boşalan tabloları free etmiyoruz; ileride optimize edilebilir.
+//  Verilen sanal adres için PT entry'yi sıfırlar, boşalan tabloları
+//  söker, ardından TLB flush (invlpg) yapar.
 // ============================================================================
 
 void paging_unmap(uint64_t virt)
@@ -251,27 +855,503 @@ void paging_unmap(uint64_t virt)
     if (!g_kernel_pml4)
         return;
 
-    uint16_t pml4_i = PML4_INDEX(virt);
-    uint16_t pdpt_i = PDPT_INDEX(virt);
-    uint16_t pd_i   = PD_INDEX(virt);
-    uint16_t pt_i   = PT_INDEX(virt);
+    uint64_t size;
+    ayken_pte_t *e = paging_walk(g_kernel_pml4, virt, &size);
 
-    ayken_pte_t pml4e = g_kernel_pml4[pml4_i];
-    if (!(pml4e & AYKEN_PTE_PRESENT)) return;
-    ayken_pte_t *pdpt = (ayken_pte_t *)phys_to_virt(pml4e & AYKEN_PTE_ADDR_MASK);
+    // Büyük sayfanın içinden tek 4KB: 4KB PTE'ye kadar böl
+    while (e && size != AYKEN_FRAME_SIZE) {
+        if (split_huge_entry(e, size) != 0)
+            return;
+        e = paging_walk(g_kernel_pml4, virt, &size);
+    }
+    if (!e) return;
 
-    ayken_pte_t pdpte = pdpt[pdpt_i];
-    if (!(pdpte & AYKEN_PTE_PRESENT)) return;
-    ayken_pte_t *pd = (ayken_pte_t *)phys_to_virt(pdpte & AYKEN_PTE_ADDR_MASK);
+    pte_set(e, 0);
 
-    ayken_pte_t pde = pd[pd_i];
-    if (!(pde & AYKEN_PTE_PRESENT)) return;
-    ayken_pte_t *pt = (ayken_pte_t *)phys_to_virt(pde & AYKEN_PTE_ADDR_MASK);
+    // TLB flush
+    paging_tlb_gather_t g = { .count = 0 };
+    tlb_gather_add(&g, virt);
+    prune_tables(g_kernel_pml4, virt, &g);
+    tlb_gather_flush(&g);
+}
 
-    pt[pt_i] = 0;
+// virt'te page_size'lık bir büyük sayfa varsa kaldırır ve fiziksel
+// tabanını döner; yoksa (4KB map'ler ya da map yok) 0.
+uint64_t paging_unmap_huge(uint64_t virt, uint64_t page_size)
+{
+    if (!g_kernel_pml4 || (virt & (page_size - 1)))
+        return 0;
+
+    uint64_t size;
+    ayken_pte_t *e = paging_walk(g_kernel_pml4, virt, &size);
+    if (!e || size != page_size)
+        return 0;
+
+    uint64_t phys = *e & AYKEN_PTE_ADDR_MASK & ~(page_size - 1);
+    pte_set(e, 0);
+
+    paging_tlb_gather_t g = { .count = 0 };
+    tlb_gather_add(&g, virt);
+    prune_tables(g_kernel_pml4, virt, &g);
+    tlb_gather_flush(&g);
+    return phys;
+}
+
+
+// ============================================================================
+//  paging_map_range / paging_unmap_range
+//
+//  Ardışık sanal aralık için tablolar PT başına bir kez yürünür; PT
+//  girişleri sıkı bir döngüde doldurulur/temizlenir. Geçersizlemeler
+//  TLB gather'da toplanıp işlem sonunda bir kez flush edilir.
+// ============================================================================
+
+static int paging_map_range_into_root(ayken_pte_t *root,
+                                      uint64_t virt,
+                                      const uint64_t *frames,
+                                      uint64_t count,
+                                      uint64_t flags,
+                                      paging_tlb_gather_t *g)
+{
+    uint64_t entry_flags = leaf_flags(flags);
+    uint64_t i = 0;
+
+    while (i < count) {
+        uint64_t va = virt + i * AYKEN_FRAME_SIZE;
+        ayken_pte_t *pt = get_or_create_pt(root, va, flags);
+        if (!pt)
+            return -1;
+
+        uint16_t added = 0;
+        for (uint64_t idx = PT_INDEX(va); idx < AYKEN_PT_ENTRIES && i < count;
+             ++idx, ++i, va += AYKEN_FRAME_SIZE) {
+            if (pt[idx] & AYKEN_PTE_PRESENT) {
+                if (g)
+                    tlb_gather_add(g, va);
+            } else {
+                added++;
+            }
+            pt[idx] = (frames[i] & AYKEN_PTE_ADDR_MASK) | entry_flags;
+        }
+
+        uint16_t *cnt = table_count(pt);
+        if (cnt)
+            *cnt += added;
+    }
+
+    return 0;
+}
+
+int paging_map_range(uint64_t virt, const uint64_t *frames,
+                     uint64_t count, uint64_t flags)
+{
+    if (!g_kernel_pml4) {
+        fb_print("[AykenOS][paging] ERROR: paging_init() not called.\n");
+        return -1;
+    }
+
+    paging_tlb_gather_t g = { .count = 0 };
+    int r = paging_map_range_into_root(g_kernel_pml4, virt, frames, count, flags, &g);
+    tlb_gather_flush(&g);
+    return r;
+}
+
+// Henüz çalışmayan bir adres alanı için: TLB'de girişi olamaz, flush yok
+int paging_map_range_in_pml4(uint64_t pml4_phys, uint64_t virt,
+                             const uint64_t *frames, uint64_t count,
+                             uint64_t flags)
+{
+    ayken_pte_t *root = (ayken_pte_t *)phys_to_virt(pml4_phys);
+    return paging_map_range_into_root(root, virt, frames, count, flags, NULL);
+}
+
+// va'dan sonraki 'size' sınırı (aralık sonu ya da adres alanı taşması → end)
+static inline uint64_t next_boundary(uint64_t va, uint64_t size, uint64_t end)
+{
+    uint64_t next = (va | (size - 1)) + 1;
+    return (next == 0 || next > end) ? end : next;
+}
+
+// Frame'i gather'a bırakır; flush'tan sonra allocator'a döner.
+// Sıfır frame'inin sahibi yok, hiç geri verilmez.
+static inline void unmap_release(paging_tlb_gather_t *g, uint64_t phys,
+                                 uint64_t size, int free_frames)
+{
+    if (!free_frames || phys == g_zero_frame)
+        return;
+
+    if (g->frame_count == PAGING_TLB_GATHER_MAX)
+        tlb_gather_flush(g);
+
+    g->frames[g->frame_count]      = phys;
+    g->frame_pages[g->frame_count] = size / AYKEN_FRAME_SIZE;
+    g->frame_count++;
+}
+
+// Dönüş: kaldırılan map'lerin 4KB sayfa karşılığı
+static uint64_t paging_unmap_range_in_root(ayken_pte_t *root, uint64_t virt,
+                                           uint64_t size, int free_frames,
+                                           paging_tlb_gather_t *g)
+{
+    uint64_t end   = virt + size;
+    uint64_t va    = virt & ~(AYKEN_FRAME_SIZE - 1);
+    uint64_t pages = 0;
+
+    while (va < end) {
+        uint64_t chunk = va;
+
+        ayken_pte_t pml4e = root[PML4_INDEX(va)];
+        if (!(pml4e & AYKEN_PTE_PRESENT)) {
+            va = next_boundary(va, 1ULL << 39, end);
+            continue;
+        }
+        ayken_pte_t *pdpt = (ayken_pte_t *)phys_to_virt(pml4e & AYKEN_PTE_ADDR_MASK);
+
+        ayken_pte_t *pdpte = &pdpt[PDPT_INDEX(va)];
+        if (!(*pdpte & AYKEN_PTE_PRESENT)) {
+            va = next_boundary(va, AYKEN_PAGE_SIZE_1G, end);
+            continue;
+        }
+        if (*pdpte & AYKEN_PTE_HUGE) {
+            if (!(va & (AYKEN_PAGE_SIZE_1G - 1)) && end - va >= AYKEN_PAGE_SIZE_1G) {
+                uint64_t phys = *pdpte & AYKEN_PTE_ADDR_MASK & ~(AYKEN_PAGE_SIZE_1G - 1);
+                pte_set(pdpte, 0);
+                tlb_gather_add(g, va);
+                unmap_release(g, phys, AYKEN_PAGE_SIZE_1G, free_frames);
+                pages += AYKEN_PAGE_SIZE_1G / AYKEN_FRAME_SIZE;
+                prune_tables(root, chunk, g);
+                va += AYKEN_PAGE_SIZE_1G;
+                continue;
+            }
+            if (split_huge_entry(pdpte, AYKEN_PAGE_SIZE_1G) != 0)
+                break;
+        }
+        ayken_pte_t *pd = (ayken_pte_t *)phys_to_virt(*pdpte & AYKEN_PTE_ADDR_MASK);
+
+        ayken_pte_t *pde = &pd[PD_INDEX(va)];
+        if (!(*pde & AYKEN_PTE_PRESENT)) {
+            va = next_boundary(va, AYKEN_PAGE_SIZE_2M, end);
+            continue;
+        }
+        if (*pde & AYKEN_PTE_HUGE) {
+            if (!(va & (AYKEN_PAGE_SIZE_2M - 1)) && end - va >= AYKEN_PAGE_SIZE_2M) {
+                uint64_t phys = *pde & AYKEN_PTE_ADDR_MASK & ~(AYKEN_PAGE_SIZE_2M - 1);
+                pte_set(pde, 0);
+                tlb_gather_add(g, va);
+                unmap_release(g, phys, AYKEN_PAGE_SIZE_2M, free_frames);
+                pages += AYKEN_PAGE_SIZE_2M / AYKEN_FRAME_SIZE;
+                prune_tables(root, chunk, g);
+                va += AYKEN_PAGE_SIZE_2M;
+                continue;
+            }
+            if (split_huge_entry(pde, AYKEN_PAGE_SIZE_2M) != 0)
+                break;
+        }
+        ayken_pte_t *pt = (ayken_pte_t *)phys_to_virt(*pde & AYKEN_PTE_ADDR_MASK);
+
+        // Bu PT'nin kapsadığı kısım tek döngüde
+        uint64_t pt_end = next_boundary(va, AYKEN_PAGE_SIZE_2M, end);
+        uint16_t removed = 0;
+        for (; va < pt_end; va += AYKEN_FRAME_SIZE) {
+            ayken_pte_t *pte = &pt[PT_INDEX(va)];
+            if (!(*pte & AYKEN_PTE_PRESENT))
+                continue;
+
+            uint64_t phys = *pte & AYKEN_PTE_ADDR_MASK;
+            *pte = 0;
+            removed++;
+            tlb_gather_add(g, va);
+            unmap_release(g, phys, AYKEN_FRAME_SIZE, free_frames);
+        }
+
+        pages += removed;
+
+        uint16_t *cnt = table_count(pt);
+        if (cnt && removed) {
+            *cnt -= removed;
+            prune_tables(root, chunk, g);
+        }
+    }
+
+    return pages;
+}
+
+void paging_unmap_range(uint64_t virt, uint64_t size, int free_frames)
+{
+    if (!g_kernel_pml4 || size == 0)
+        return;
+
+    paging_tlb_gather_t g = { .count = 0 };
+    paging_unmap_range_in_root(g_kernel_pml4, virt, size, free_frames, &g);
+    tlb_gather_flush(&g);
+}
+
+// Yüklü olmayan bir adres alanı için flush yok (bkz. paging_asid_cr3);
+// yüklü olan için (munmap) geçerli PCID'de invlpg.
+uint64_t paging_unmap_range_in_pml4(uint64_t pml4_phys, uint64_t virt,
+                                    uint64_t size, int free_frames)
+{
+    if (size == 0)
+        return 0;
+
+    uint64_t cr3;
+    __asm__ volatile("mov %%cr3, %0" : "=r"(cr3));
+
+    paging_tlb_gather_t g = { .count = 0 };
+    g.inactive = (cr3 & AYKEN_PTE_ADDR_MASK) != pml4_phys;
+
+    uint64_t pages = paging_unmap_range_in_root((ayken_pte_t *)phys_to_virt(pml4_phys),
+                                                virt, size, free_frames, &g);
+    tlb_gather_flush(&g);
+    return pages;
+}
+
+
+// ============================================================================
+//  Copy-on-write
+//
+//  paging_cow_share: kaynak adres alanındaki map'li 4KB sayfaları hedefe
+//  aynı frame ile kurar. Yazılabilir olanlar iki tarafta da salt okunur
+//  ve AYKEN_PTE_COW olur; frame'e bir sahip eklenir (phys_frame_ref).
+//  İlk yazma #PF'i paging_cow_break'e düşer: frame'in başka sahibi yoksa
+//  yazma izni geri verilir, varsa özel kopya alınır.
+//  paging_map_cow_in_pml4 aynı düzeni tek sayfa için doğrudan kurar
+//  (paylaşılan sıfır sayfası).
+//  Sıfır frame'i istisnadır: refcount'u yoktur (65535 sahip sınırına
+//  takılmaz), paylaşımda sayılmaz ve cow_break onu her zaman kopyalar.
+// ============================================================================
+
+uint64_t paging_zero_frame(void)
+{
+    // İlk çağrı boot'ta (vm_init), tek CPU'da
+    if (!g_zero_frame)
+        g_zero_frame = phys_alloc_zeroed_frame();
+    return g_zero_frame;
+}
+
+static inline void copy_frame(uint64_t dst_phys, uint64_t src_phys)
+{
+    void *dst = phys_to_virt(dst_phys);
+    const void *src = phys_to_virt(src_phys);
+    uint64_t cnt = AYKEN_FRAME_SIZE / 8;
+    __asm__ volatile("rep movsq"
+                     : "+D"(dst), "+S"(src), "+c"(cnt)
+                     :: "memory");
+}
+
+// copy != 0: paylaşım yok, her map'li sayfa hedefe özel kopya olarak
+// (sıfır frame'i için yeni sıfır frame) yazılabilir kurulur; src'ye dokunulmaz.
+static int paging_share_range(uint64_t src_pml4_phys, uint64_t dst_pml4_phys,
+                              uint64_t virt, uint64_t size, int copy)
+{
+    ayken_pte_t *src = (ayken_pte_t *)phys_to_virt(src_pml4_phys);
+    ayken_pte_t *dst = (ayken_pte_t *)phys_to_virt(dst_pml4_phys);
+
+    paging_tlb_gather_t g = { .count = 0 };
+    uint64_t end = virt + size;
+    uint64_t va  = virt & ~(AYKEN_FRAME_SIZE - 1);
+    int      r   = 0;
+
+    while (va < end && r == 0) {
+        ayken_pte_t pml4e = src[PML4_INDEX(va)];
+        if (!(pml4e & AYKEN_PTE_PRESENT)) {
+            va = next_boundary(va, 1ULL << 39, end);
+            continue;
+        }
+        ayken_pte_t *pdpt = (ayken_pte_t *)phys_to_virt(pml4e & AYKEN_PTE_ADDR_MASK);
+
+        ayken_pte_t pdpte = pdpt[PDPT_INDEX(va)];
+        if (!(pdpte & AYKEN_PTE_PRESENT)) {
+            va = next_boundary(va, AYKEN_PAGE_SIZE_1G, end);
+            continue;
+        }
+
+        // User map'leri 4KB; büyük sayfa paylaşımı desteklenmiyor.
+        // 1GB yaprak PD değildir: içine inmeden önce kontrol et.
+        if (pdpte & AYKEN_PTE_HUGE) {
+            r = -1;
+            break;
+        }
+        ayken_pte_t *pd = (ayken_pte_t *)phys_to_virt(pdpte & AYKEN_PTE_ADDR_MASK);
+
+        ayken_pte_t pde = pd[PD_INDEX(va)];
+        if (!(pde & AYKEN_PTE_PRESENT)) {
+            va = next_boundary(va, AYKEN_PAGE_SIZE_2M, end);
+            continue;
+        }
+        if (pde & AYKEN_PTE_HUGE) {
+            r = -1;
+            break;
+        }
+        ayken_pte_t *pt  = (ayken_pte_t *)phys_to_virt(pde & AYKEN_PTE_ADDR_MASK);
+        ayken_pte_t *dpt = NULL;
+
+        uint64_t pt_end = next_boundary(va, AYKEN_PAGE_SIZE_2M, end);
+        for (; va < pt_end; va += AYKEN_FRAME_SIZE) {
+            ayken_pte_t e = pt[PT_INDEX(va)];
+            if (!(e & AYKEN_PTE_PRESENT))
+                continue;
+
+            if (!dpt && !(dpt = get_or_create_pt(dst, va, AYKEN_PTE_USER))) {
+                r = -1;
+                break;
+            }
+
+            uint64_t phys = e & AYKEN_PTE_ADDR_MASK;
+
+            // Sıfır frame'i zaten salt okunur ve sahipsiz: olduğu gibi kopyala
+            if (phys == g_zero_frame && !copy) {
+                pte_set(&dpt[PT_INDEX(va)], e);
+                continue;
+            }
+
+            // Kopya isteniyor ya da sayaç dolu: hedef hemen özel kopya alır
+            if (copy || phys_frame_ref(phys) != 0) {
+                uint64_t dup = (phys == g_zero_frame) ? phys_alloc_zeroed_frame()
+                                                      : phys_alloc_frame();
+                if (!dup) {
+                    r = -1;
+                    break;
+                }
+                if (phys != g_zero_frame)
+                    copy_frame(dup, phys);
+                pte_set(&dpt[PT_INDEX(va)],
+                        dup | ((e & ~AYKEN_PTE_ADDR_MASK & ~AYKEN_PTE_COW) |
+                               ((e & AYKEN_PTE_COW) ? AYKEN_PTE_WRITABLE : 0)));
+                continue;
+            }
+
+            if (e & AYKEN_PTE_WRITABLE) {
+                e = (e & ~AYKEN_PTE_WRITABLE) | AYKEN_PTE_COW;
+                pt[PT_INDEX(va)] = e;
+                tlb_gather_add(&g, va);
+            }
+            pte_set(&dpt[PT_INDEX(va)], e);
+        }
+    }
+
+    tlb_gather_flush(&g);
+    return r;
+}
+
+int paging_cow_share(uint64_t src_pml4_phys, uint64_t dst_pml4_phys,
+                     uint64_t virt, uint64_t size)
+{
+    return paging_share_range(src_pml4_phys, dst_pml4_phys, virt, size, 0);
+}
+
+int paging_copy_range(uint64_t src_pml4_phys, uint64_t dst_pml4_phys,
+                      uint64_t virt, uint64_t size)
+{
+    return paging_share_range(src_pml4_phys, dst_pml4_phys, virt, size, 1);
+}
+
+int paging_map_cow_in_pml4(uint64_t pml4_phys, uint64_t virt,
+                           uint64_t phys, uint64_t flags)
+{
+    ayken_pte_t *root = (ayken_pte_t *)phys_to_virt(pml4_phys);
+    ayken_pte_t *pt   = get_or_create_pt(root, virt, flags);
+    if (!pt)
+        return -1;
+
+    // leaf_flags yazmayı hep açar: burada salt okunur + COW
+    uint64_t entry_flags = leaf_flags(flags) & ~AYKEN_PTE_WRITABLE;
+    if (flags & AYKEN_PTE_WRITABLE)
+        entry_flags |= AYKEN_PTE_COW;
+
+    pte_set(&pt[PT_INDEX(virt)], (phys & AYKEN_PTE_ADDR_MASK) | entry_flags);
+    return 0;
+}
+
+int paging_cow_break(uint64_t pml4_phys, uint64_t virt)
+{
+    uint64_t size;
+    ayken_pte_t *pte = paging_walk((ayken_pte_t *)phys_to_virt(pml4_phys), virt, &size);
+    if (!pte || size != AYKEN_FRAME_SIZE || !(*pte & AYKEN_PTE_COW))
+        return -1;
+
+    uint64_t phys  = *pte & AYKEN_PTE_ADDR_MASK;
+    uint64_t flags = (*pte & ~AYKEN_PTE_ADDR_MASK & ~AYKEN_PTE_COW) | AYKEN_PTE_WRITABLE;
+
+    if (phys == g_zero_frame) {
+        // Sahipsiz sıfır frame'i: her zaman yeni (sıfır) frame, bırakılacak ref yok
+        uint64_t copy = phys_alloc_zeroed_frame();
+        if (!copy)
+            return -1;
+        *pte = copy | flags;
+    } else if (phys_frame_refcount(phys) > 1) {
+        uint64_t copy = phys_alloc_frame();
+        if (!copy)
+            return -1;
+        copy_frame(copy, phys);
+        *pte = copy | flags;
+        phys_free_frame(phys);      // paylaşımdan bu sahip düşer
+    } else {
+        *pte = phys | flags;        // son sahip: kopyaya gerek yok
+    }
 
-    // TLB flush
     __asm__ volatile("invlpg (%0)" :: "r"(virt) : "memory");
+    return 0;
+}
+
+
+// ============================================================================
+//  paging_map_anon
+//
+//  [virt, virt+size) için frame ayırıp map eder: 2MB hizalı tam dilimler
+//  ardışık 512 frame bulunursa tek büyük sayfa, gerisi 4KB'lık batch'ler
+//  halinde paging_map_range ile. Başarısızlıkta hiçbir şey map'li kalmaz.
+// ============================================================================
+
+#define PAGING_ANON_BATCH   64
+#define PAGING_HUGE_FRAMES  (AYKEN_PAGE_SIZE_2M / AYKEN_FRAME_SIZE)
+
+int paging_map_anon(uint64_t virt, uint64_t size, uint64_t flags)
+{
+    uint64_t frames[PAGING_ANON_BATCH];
+    uint64_t off = 0;
+    void    *site = MM_STATS_CALLER;    // telemetri: belleğin sahibi
+
+    while (off < size) {
+        uint64_t va = virt + off;
+
+        if (!(va & (AYKEN_PAGE_SIZE_2M - 1)) && size - off >= AYKEN_PAGE_SIZE_2M) {
+            uint64_t phys = phys_alloc_frames_at(PAGING_HUGE_FRAMES, site);
+            if (phys) {
+                if (paging_map_huge(va, phys, AYKEN_PAGE_SIZE_2M, flags) == 0) {
+                    off += AYKEN_PAGE_SIZE_2M;
+                    continue;
+                }
+                phys_free_frames(phys, PAGING_HUGE_FRAMES);
+            }
+        }
+
+        // Bir sonraki 2MB sınırına kadar (orada yeniden büyük sayfa denenir)
+        uint64_t limit = (next_boundary(va, AYKEN_PAGE_SIZE_2M, virt + size) - va)
+                         / AYKEN_FRAME_SIZE;
+        if (limit > PAGING_ANON_BATCH)
+            limit = PAGING_ANON_BATCH;
+
+        uint64_t n = 0;
+        while (n < limit) {
+            uint64_t f = phys_alloc_frame_at(site);
+            if (!f)
+                break;
+            frames[n++] = f;
+        }
+
+        if (n == 0 || paging_map_range(va, frames, n, flags) != 0) {
+            paging_unmap_range(va, n * AYKEN_FRAME_SIZE, 0);
+            for (uint64_t i = 0; i < n; ++i)
+                phys_free_frame(frames[i]);
+            paging_unmap_range(virt, off, 1);
+            return -1;
+        }
+
+        off += n * AYKEN_FRAME_SIZE;
+    }
+
+    return 0;
 }
 
 
@@ -287,27 +1367,57 @@ uint64_t paging_get_phys(uint64_t virt)
     if (!g_kernel_pml4)
         return 0;
 
-    uint16_t pml4_i = PML4_INDEX(virt);
-    uint16_t pdpt_i = PDPT_INDEX(virt);
-    uint16_t pd_i   = PD_INDEX(virt);
-    uint16_t pt_i   = PT_INDEX(virt);
+    uint64_t size;
+    ayken_pte_t *e = paging_walk(g_kernel_pml4, virt, &size);
+    if (!e) return 0;
 
-    ayken_pte_t pml4e = g_kernel_pml4[pml4_i];
-    if (!(pml4e & AYKEN_PTE_PRESENT)) return 0;
-    ayken_pte_t *pdpt = (ayken_pte_t *)phys_to_virt(pml4e & AYKEN_PTE_ADDR_MASK);
+    // Büyük sayfada: virt'i içeren 4KB frame
+    uint64_t base = *e & AYKEN_PTE_ADDR_MASK & ~(size - 1);
+    return base + (virt & (size - 1) & ~(AYKEN_FRAME_SIZE - 1));
+}
+
+// ============================================================================
+//  paging_for_each_table_frame
+//
+//  Verilen PML4 hiyerarşisindeki her page table frame'i için (kök dahil)
+//  callback çağırır. Huge (PS) girişlerin altına inilmez.
+//  Boot belleği geri alınırken canlı tabloları korumak için kullanılır.
+// ============================================================================
+
+void paging_for_each_table_frame(uint64_t pml4_phys,
+                                 void (*fn)(uint64_t phys, void *ctx),
+                                 void *ctx)
+{
+    if (!pml4_phys || !fn)
+        return;
+
+    fn(pml4_phys, ctx);
+    ayken_pte_t *pml4 = (ayken_pte_t *)phys_to_virt(pml4_phys);
+
+    for (int i = 0; i < AYKEN_PT_ENTRIES; ++i) {
+        if (!(pml4[i] & AYKEN_PTE_PRESENT))
+            continue;
+
+        uint64_t pdpt_phys = pml4[i] & AYKEN_PTE_ADDR_MASK;
+        fn(pdpt_phys, ctx);
+        ayken_pte_t *pdpt = (ayken_pte_t *)phys_to_virt(pdpt_phys);
 
-    ayken_pte_t pdpte = pdpt[pdpt_i];
-    if (!(pdpte & AYKEN_PTE_PRESENT)) return 0;
-    ayken_pte_t *pd = (ayken_pte_t *)phys_to_virt(pdpte & AYKEN_PTE_ADDR_MASK);
+        for (int j = 0; j < AYKEN_PT_ENTRIES; ++j) {
+            if (!(pdpt[j] & AYKEN_PTE_PRESENT) || (pdpt[j] & AYKEN_PTE_HUGE))
+                continue;
 
-    ayken_pte_t pde = pd[pd_i];
-    if (!(pde & AYKEN_PTE_PRESENT)) return 0;
-    ayken_pte_t *pt = (ayken_pte_t *)phys_to_virt(pde & AYKEN_PTE_ADDR_MASK);
+            uint64_t pd_phys = pdpt[j] & AYKEN_PTE_ADDR_MASK;
+            fn(pd_phys, ctx);
+            ayken_pte_t *pd = (ayken_pte_t *)phys_to_virt(pd_phys);
 
-    ayken_pte_t pte = pt[pt_i];
-    if (!(pte & AYKEN_PTE_PRESENT)) return 0;
+            for (int k = 0; k < AYKEN_PT_ENTRIES; ++k) {
+                if (!(pd[k] & AYKEN_PTE_PRESENT) || (pd[k] & AYKEN_PTE_HUGE))
+                    continue;
 
-    return (pte & AYKEN_PTE_ADDR_MASK);
+                fn(pd[k] & AYKEN_PTE_ADDR_MASK, ctx);
+            }
+        }
+    }
 }
 
 uint64_t paging_get_kernel_pml4_phys(void)
@@ -315,6 +1425,26 @@ uint64_t paging_get_kernel_pml4_phys(void)
     return g_kernel_pml4_phys;
 }
 
+// Kernel yarısı kopya olarak (pte_set'siz) yazıldığı için sayaca girmez;
+// user yarısı vm_space_destroy'dan sonra boş olmalıdır.
+void paging_destroy_user_pml4(uint64_t pml4_phys)
+{
+    if (!pml4_phys || pml4_phys == g_kernel_pml4_phys)
+        return;
+
+    ayken_pte_t *root = (ayken_pte_t *)phys_to_virt(pml4_phys);
+    for (int i = AYKEN_PT_ENTRIES / 2; i < AYKEN_PT_ENTRIES; ++i)
+        root[i] = 0;
+
+    if (!table_is_empty(root)) {
+        fb_print("[AykenOS][paging] WARNING: user PML4 still has mappings, leaking it.\n");
+        return;
+    }
+
+    // PCID'ler bir nesil içinde yeniden verilmez; kök hemen tekrar kullanılabilir
+    pt_cache_put(pml4_phys);
+}
+
 uint64_t paging_create_user_pml4(void)
 {
     uint64_t new_pml4_phys = paging_alloc_page_table();
@@ -331,6 +1461,110 @@ uint64_t paging_create_user_pml4(void)
 }
 
 
+// ============================================================================
+//  Direct map
+//
+//  EFI map'teki her RAM aralığı DIRECT_MAP_BASE + phys'e paging_map_region
+//  ile (hizanın izin verdiği en büyük sayfa) map edilir; delikler (MMIO)
+//  map edilmez. Kurulum sırasında ayrılan tablolar hâlâ boot penceresinden
+//  yazılır: allocator o ana kadar ilk 2 GiB'in üstünden frame vermez.
+//  Tamamı doğrulanınca phys_to_virt direct map'e geçer.
+// ============================================================================
+
+typedef struct {
+    uint64_t bytes;
+    int      ok;
+} direct_map_ctx_t;
+
+static void direct_map_range(uint64_t start, uint64_t end, void *arg)
+{
+    direct_map_ctx_t *ctx = (direct_map_ctx_t *)arg;
+
+    if (end > DIRECT_MAP_SIZE) {
+        fb_print("[AykenOS][paging] WARNING: RAM above direct map limit ignored.\n");
+        end = DIRECT_MAP_SIZE;
+    }
+    if (start >= end)
+        return;
+
+    paging_map_region(DIRECT_MAP_BASE + start, start, end - start, 0);
+
+    // 4KB yolu hata döndürmüyor: aralığın iki ucunu doğrula
+    uint64_t last = end - AYKEN_FRAME_SIZE;
+    if (paging_get_phys(DIRECT_MAP_BASE + start) != start ||
+        paging_get_phys(DIRECT_MAP_BASE + last) != last) {
+        ctx->ok = 0;
+        return;
+    }
+
+    ctx->bytes += end - start;
+}
+
+static void paging_build_direct_map(void)
+{
+    direct_map_ctx_t ctx = { .bytes = 0, .ok = 1 };
+    phys_mem_for_each_ram_range(direct_map_range, &ctx);
+
+    if (!ctx.ok || ctx.bytes == 0) {
+        fb_print("[AykenOS][paging] WARNING: direct map incomplete, using boot window.\n");
+        return;
+    }
+
+    // Bundan sonra tüm tablo erişimleri direct map'ten
+    g_phys_virt_base = DIRECT_MAP_BASE;
+    g_kernel_pml4    = (ayken_pte_t *)phys_to_virt(g_kernel_pml4_phys);
+
+    // Boot penceresinin üstündeki frame'ler artık erişilebilir
+    phys_mem_set_alloc_limit(DIRECT_MAP_SIZE);
+
+    fb_print("[AykenOS][paging] Direct map: ");
+    fb_print_uint(ctx.bytes >> 20);
+    fb_print(" MiB RAM.\n");
+}
+
+
+// ============================================================================
+//  PAT
+//
+//  PA0..PA3 power-on varsayılanında bırakılır (mevcut PWT/PCD kullanımı
+//  anlamını korur); PA4 write-combining olur. PA5..PA7 = WT, UC-, UC.
+//  Yazım, SDM'deki sıraya uygun olarak cache boşaltılarak ve TLB
+//  temizlenerek yapılır (yalnızca BSP, boot'ta).
+// ============================================================================
+
+#define MSR_IA32_PAT        0x277
+
+#define PAT_UC              0x00ULL
+#define PAT_WC              0x01ULL
+#define PAT_WT              0x04ULL
+#define PAT_WB              0x06ULL
+#define PAT_UC_MINUS        0x07ULL
+
+#define PAT_ENTRY(i, t)     ((t) << ((i) * 8))
+
+static void paging_init_pat(void)
+{
+    if (!cpu_has_pat()) {
+        fb_print("[AykenOS][paging] PAT not supported, WC maps fall back to UC-.\n");
+        return;
+    }
+
+    uint64_t pat = PAT_ENTRY(0, PAT_WB) | PAT_ENTRY(1, PAT_WT) |
+                   PAT_ENTRY(2, PAT_UC_MINUS) | PAT_ENTRY(3, PAT_UC) |
+                   PAT_ENTRY(4, PAT_WC) | PAT_ENTRY(5, PAT_WT) |
+                   PAT_ENTRY(6, PAT_UC_MINUS) | PAT_ENTRY(7, PAT_UC);
+
+    uint64_t flags = cpu_irq_save();
+    __asm__ volatile("wbinvd" ::: "memory");
+    cpu_wrmsr(MSR_IA32_PAT, pat);
+    __asm__ volatile("wbinvd" ::: "memory");
+    tlb_flush_all();
+    cpu_irq_restore(flags);
+
+    g_paging_pat = 1;
+}
+
+
 // ============================================================================
 //  paging_init
 //
@@ -354,36 +1588,214 @@ void paging_init(uint64_t pml4_phys)
 
     g_kernel_pml4_phys = pml4_phys;
     g_kernel_pml4      = (ayken_pte_t *)phys_to_virt(pml4_phys);
+    g_paging_1g        = cpu_has_1g_pages();
 
     load_cr3(pml4_phys);
 
-    fb_print("[AykenOS][paging] PML4 at phys=0x");
-    fb_print_hex64(pml4_phys);
+    // Salt okunur (COW) sayfalar CPL0 yazmalarında da #PF üretsin
+    uint64_t cr0;
+    __asm__ volatile("mov %%cr0, %0" : "=r"(cr0));
+    __asm__ volatile("mov %0, %%cr0" :: "r"(cr0 | CR0_WP) : "memory");
+
+    // PCID yalnızca global sayfalarla birlikte: kernel map'lerinin
+    // geçersizlenmesi (invlpg) tüm adres alanlarına ulaşmalı.
+    // PCIDE açılırken CR3[11:0] sıfır olmalı; yukarıdaki yükleme öyle.
+    uint64_t cr4;
+    __asm__ volatile("mov %%cr4, %0" : "=r"(cr4));
+    if (cpu_has_pge())
+        cr4 |= CR4_PGE;
+    if ((cr4 & CR4_PGE) && cpu_has_pcid()) {
+        cr4 |= CR4_PCIDE;
+        g_paging_pcid = 1;
+    }
+    __asm__ volatile("mov %0, %%cr4" :: "r"(cr4) : "memory");
+
+    if (g_paging_pcid)
+        fb_print("[AykenOS][paging] PCID enabled.\n");
+
+    paging_init_pat();
+
+    fb_print("[AykenOS][paging] PML4 at phys=");
+    fb_print_hex(pml4_phys);
     fb_print("\n");
 
+    // Doluluk sayaçları: söküm ve split'ler bunlara dayanıyor
+    paging_for_each_table_frame(pml4_phys, table_count_init, NULL);
+
+    paging_build_direct_map();
+
     // Burada: identity map'i temizleyelim (örnek: ilk 1GB)
     paging_drop_identity_map(0x40000000ULL); // 1GB
 
     fb_print("[AykenOS][paging] Paging is now active (no identity map).\n");
 }
 
-// paging.c'nin sonlarına doğru eklenebilir
+// ============================================================================
+//  paging_drop_identity_map
+//
+//  Tablo seviyesinde söküm: aralığın tamamen kapsadığı girişler alt
+//  ağaçlarıyla birlikte bir kerede silinir, yalnızca kısmi kenarlarda
+//  aşağı inilir. Boşalan tablo frame'leri allocator'a döner; en sonda
+//  tek bir TLB flush yapılır.
+//
+//  Bazı bootloader'lar identity ve higher-half map'lerinde aynı alt
+//  tabloları kullanır. Kernel yarısından erişilen tablolar önce bir
+//  kümeye toplanır; bu tablolara dokunulmaz, yalnızca identity'deki
+//  işaretçi silinir.
+// ============================================================================
+
+#define PAGING_KEEP_SLOTS   2048    // 2'nin kuvveti
+
+typedef struct {
+    uint64_t set[PAGING_KEEP_SLOTS];
+    uint32_t count;
+    int      overflow;    // küme taştı → paylaşım bilinmiyor, tablo free etme
+    uint64_t freed;
+} paging_drop_ctx_t;
+
+static paging_drop_ctx_t g_drop_ctx;    // yalnızca boot'ta kullanılır
+
+static inline uint32_t keep_hash(uint64_t phys)
+{
+    return (uint32_t)((phys >> 12) * 0x9E3779B1u) & (PAGING_KEEP_SLOTS - 1);
+}
+
+static void keep_add(paging_drop_ctx_t *ctx, uint64_t phys)
+{
+    if (ctx->count >= PAGING_KEEP_SLOTS * 3 / 4) {
+        ctx->overflow = 1;
+        return;
+    }
+
+    for (uint32_t h = keep_hash(phys);; h = (h + 1) & (PAGING_KEEP_SLOTS - 1)) {
+        if (ctx->set[h] == phys)
+            return;
+        if (!ctx->set[h]) {
+            ctx->set[h] = phys;
+            ctx->count++;
+            return;
+        }
+    }
+}
+
+static int keep_has(const paging_drop_ctx_t *ctx, uint64_t phys)
+{
+    for (uint32_t h = keep_hash(phys); ctx->set[h]; h = (h + 1) & (PAGING_KEEP_SLOTS - 1)) {
+        if (ctx->set[h] == phys)
+            return 1;
+    }
+    return 0;
+}
+
+// Kernel yarısındaki (PML4[256..511]) tüm alt tablo frame'leri
+static void keep_collect_kernel_half(paging_drop_ctx_t *ctx)
+{
+    for (int i = AYKEN_PT_ENTRIES / 2; i < AYKEN_PT_ENTRIES; ++i) {
+        if (!(g_kernel_pml4[i] & AYKEN_PTE_PRESENT))
+            continue;
+
+        uint64_t pdpt_phys = g_kernel_pml4[i] & AYKEN_PTE_ADDR_MASK;
+        keep_add(ctx, pdpt_phys);
+        ayken_pte_t *pdpt = (ayken_pte_t *)phys_to_virt(pdpt_phys);
+
+        for (int j = 0; j < AYKEN_PT_ENTRIES; ++j) {
+            if (!(pdpt[j] & AYKEN_PTE_PRESENT) || (pdpt[j] & AYKEN_PTE_HUGE))
+                continue;
+
+            uint64_t pd_phys = pdpt[j] & AYKEN_PTE_ADDR_MASK;
+            keep_add(ctx, pd_phys);
+            ayken_pte_t *pd = (ayken_pte_t *)phys_to_virt(pd_phys);
+
+            for (int k = 0; k < AYKEN_PT_ENTRIES; ++k) {
+                if ((pd[k] & AYKEN_PTE_PRESENT) && !(pd[k] & AYKEN_PTE_HUGE))
+                    keep_add(ctx, pd[k] & AYKEN_PTE_ADDR_MASK);
+            }
+        }
+    }
+}
+
+// level: 3 = PML4 (giriş 512 GiB kapsar) ... 0 = PT (giriş 4 KiB)
+static void drop_table_range(ayken_pte_t *table, int level, uint64_t base,
+                             uint64_t start, uint64_t end,
+                             paging_drop_ctx_t *ctx)
+{
+    uint64_t span = 1ULL << (12 + 9 * level);
+    uint64_t first = start > base ? (start - base) / span : 0;
+
+    for (uint64_t i = first; i < AYKEN_PT_ENTRIES; ++i) {
+        uint64_t va = base + i * span;
+        if (va >= end)
+            break;
+
+        ayken_pte_t e = table[i];
+        if (!(e & AYKEN_PTE_PRESENT))
+            continue;
+
+        uint64_t lo   = va < start ? start : va;
+        uint64_t hi   = va + span > end ? end : va + span;
+        int      full = (lo == va && hi == va + span);
+
+        if (level == 0 || (e & AYKEN_PTE_HUGE)) {
+            if (full) {
+                pte_set(&table[i], 0);
+                continue;
+            }
+            // Kısmen kapsanan büyük sayfa: böl ve kenara in
+            if (split_huge_entry(&table[i], span) != 0)
+                continue;
+            e = table[i];
+        }
+
+        uint64_t child_phys = e & AYKEN_PTE_ADDR_MASK;
+        int shared = keep_has(ctx, child_phys);
+
+        if (shared) {
+            // Kernel yarısının da kullandığı tablo: içeriğine dokunma
+            if (full)
+                pte_set(&table[i], 0);
+            continue;
+        }
+
+        ayken_pte_t *child = (ayken_pte_t *)phys_to_virt(child_phys);
+        drop_table_range(child, level - 1, va, lo, hi, ctx);
+
+        if (full || table_is_empty(child)) {
+            pte_set(&table[i], 0);
+            // Reclaim bekleyen boot bölgesindekiler reclaim ile döner
+            if (!ctx->overflow && !phys_mem_is_reclaimable(child_phys))
+                phys_free_frame(child_phys);
+            ctx->freed++;
+        }
+    }
+}
 
 // [0, limit) aralığındaki identity map'leri kaldır
 void paging_drop_identity_map(uint64_t limit_phys)
 {
-    fb_print("[paging] Dropping identity map up to 0x");
-    fb_print_hex64(limit_phys);
+    fb_print("[paging] Dropping identity map up to ");
+    fb_print_hex(limit_phys);
     fb_print("\n");
 
-    // 4KB adım
-    for (uint64_t addr = 0; addr < limit_phys; addr += AYKEN_FRAME_SIZE) {
-        // Sanal = fiziksel (identity)
-        paging_unmap(addr);
-    }
+    if (!g_kernel_pml4 || limit_phys == 0)
+        return;
 
-    // TLB global temizlik
-    uint64_t cr3;
-    __asm__ volatile("mov %%cr3, %0" : "=r"(cr3));
-    __asm__ volatile("mov %0, %%cr3" :: "r"(cr3));
+    paging_drop_ctx_t *ctx = &g_drop_ctx;
+    for (uint32_t i = 0; i < PAGING_KEEP_SLOTS; ++i)
+        ctx->set[i] = 0;
+    ctx->count    = 0;
+    ctx->overflow = 0;
+    ctx->freed    = 0;
+
+    keep_collect_kernel_half(ctx);
+
+    // Identity yalnızca alt yarıda olabilir
+    uint64_t limit = limit_phys < (1ULL << 47) ? limit_phys : (1ULL << 47);
+    drop_table_range(g_kernel_pml4, 3, 0, 0, limit, ctx);
+
+    // TLB global temizlik (tek seferde)
+    tlb_flush_all();
+
+    fb_print("[paging] identity tables released: ");
+    fb_print_uint(ctx->freed);
+    fb_print("\n");
 }
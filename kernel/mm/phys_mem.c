@@ -2,13 +2,32 @@
 // ============================================================================
 //  AykenOS Physical Memory Manager (bitmap tabanlı frame allocator)
 //  Açıklamalı, klasik + gelişmiş fonksiyonlarla güncellenmiş tam sürüm
+//
+//  - Sparse section'lar: fiziksel adres alanı 128 MiB'lik section'lara
+//    bölünür; yalnızca RAM içeren section'lar için metadata tutulur.
+//    Tüm metadata phys_mem_init sırasında usable RAM'in içinden kesilir,
+//    bu yüzden maliyet kurulu RAM ile orantılıdır (sabit 4 GiB sınırı yok):
+//    section başına ~140 KiB (bitmap + buddy + refs/aux sayaçları), yani
+//    RAM'in ~%0.1'i.
+//  - Direct map kurulana kadar frame'lere yalnızca ilk 2 GiB'lik boot
+//    penceresinden erişilebilir; allocator o zamana kadar bu sınırın
+//    üstünden frame vermez (phys_mem_set_alloc_limit).
+//  - Section bitmap'i: frame başına 1 bit, doğruluk kaynağı (used/free)
+//  - Binary buddy (order 0..PHYS_BUDDY_MAX_ORDER): ardışık frame
+//    istekleri (phys_alloc_frames / phys_free_frames) için O(log n)
+//    ayırma + otomatik birleştirme (coalesce)
+//  - Per-CPU magazine: tek frame alloc/free önce CPU'ya özel küçük
+//    cache'e gider; global yapı (bitmap + buddy) yalnızca toplu
+//    refill/drain sırasında g_phys_lock altında ellenir.
 // ============================================================================
 
 #include <stdint.h>
 #include <stddef.h>
-#include "include/mm.h"
-#include "include/ayken.h"
-#include "drivers/console/fb_console.h"
+#include "../include/mm.h"
+#include "../include/ayken.h"
+#include "../drivers/console/fb_console.h"
+#include "../arch/x86_64/cpu.h"
+#include "../arch/x86_64/spinlock.h"
 
 // ---------------------------------------------------------------------------
 // EFI memory map entry (UEFI’nin EFI_MEMORY_DESCRIPTOR eşleniği)
@@ -23,62 +42,783 @@ typedef struct {
     uint64_t attrib;
 } ayken_efi_mmap_entry_t;
 
+#define AYKEN_EFI_MEM_LOADER_CODE    1   // bootloader kodu
+#define AYKEN_EFI_MEM_LOADER_DATA    2   // bootloader verisi (memory map pool dahil)
+#define AYKEN_EFI_MEM_BS_CODE        3   // EfiBootServicesCode
+#define AYKEN_EFI_MEM_BS_DATA        4   // EfiBootServicesData
 #define AYKEN_EFI_MEM_CONVENTIONAL   7   // UEFI: kullanılabilir RAM türü
 
+// Metadata'ya paging_phys_to_virt() ile erişiyoruz; higher-half pencere
+// (phys + KERNEL_VIRT_BASE) yalnızca ilk 2 GiB'i kapsıyor. Aynı sınır
+// direct map'e kadar ayrılan frame'ler için de geçerli.
+#define PHYS_META_LIMIT     (2ULL * 1024ULL * 1024ULL * 1024ULL)
+
 // ---------------------------------------------------------------------------
+// Section düzeni
+//
 // Bitmap: Her bit = 1 frame (4 KB)
 //
 // 0 = free
 // 1 = used (ayrılmış)
 //
-// Toplam frame sayısı AYKEN_MAX_FRAMES kadar olabilir.
+// Tek frame aramasını sınırlamak için bitmap 64-bit word'ler halinde
+// tutulur ve üzerine özet seviyeleri kurulur:
+//
+//   sec->sum bit w = 1        →  sec->bitmap[w] içinde en az bir boş frame
+//   g_sec_free_map bit s = 1  →  section s'de boş frame var
+//   g_sec_free_sum bit w = 1  →  g_sec_free_map[w] != 0
+//
+// Boş frame bulmak: sum → map → section sum → bitmap, her seviyede tzcnt.
+// ---------------------------------------------------------------------------
+
+#define PHYS_SECTION_FRAMES     (1ULL << (AYKEN_PHYS_SECTION_SHIFT - 12))
+#define PHYS_SECTION_WORDS      (PHYS_SECTION_FRAMES / 64)
+#define PHYS_SECTION_SUM_WORDS  ((PHYS_SECTION_WORDS + 63) / 64)
+
+// ---------------------------------------------------------------------------
+// Buddy allocator durumu
+//
+// Her order için ayrı bir "free blok" bitmap'i tutulur:
+//   order k, bit b = 1  →  [b << k, (b + 1) << k) frame aralığı tek parça
+//                          halinde boş ve bu order'da bir buddy bloğu.
+//
+// Liste düğümlerini boş frame'lerin içine yazmıyoruz; higher-half mapping
+// RAM'in tamamını kapsamadığı için metadata tamamen bitmap'lerde duruyor.
+// Bir blok ve buddy'si: b ve (b ^ 1). En büyük blok bir section'dan
+// küçük olduğu için buddy hiçbir zaman section sınırını geçmez.
 // ---------------------------------------------------------------------------
 
-static uint8_t  g_frame_bitmap[AYKEN_MAX_FRAMES / 8];
+#define PHYS_BUDDY_MAX_ORDER   10   // 2^10 frame = 4 MiB en büyük blok
+#define PHYS_BUDDY_ORDERS      (PHYS_BUDDY_MAX_ORDER + 1)
+#define PHYS_BUDDY_NONE        (~0ULL)
+
+// order 0 için SECTION_FRAMES bit, her üst order yarısı → toplam ≤ 2 katı
+#define PHYS_SECTION_BUDDY_WORDS  (2 * PHYS_SECTION_WORDS)
+
+typedef struct {
+    uint64_t bitmap[PHYS_SECTION_WORDS];            // 1 = used
+    uint64_t sum[PHYS_SECTION_SUM_WORDS];           // boş frame'li word'ler
+    uint64_t buddy[PHYS_SECTION_BUDDY_WORDS];       // order haritaları art arda
+    uint32_t buddy_free[PHYS_BUDDY_ORDERS];         // order başına blok sayısı
+    uint32_t buddy_hint[PHYS_BUDDY_ORDERS];         // ilk aday word
+    uint16_t refs[PHYS_SECTION_FRAMES];             // ek sahip sayısı (COW)
+    uint16_t aux[PHYS_SECTION_FRAMES];              // sahibin kullanımı (page table doluluğu)
+    uint64_t index;                                 // section numarası
+    uint64_t free_frames;
+} __attribute__((aligned(64))) phys_section_t;
+
+// Tüm section'larda ortak order → word offset/uzunluk tabloları
+static uint32_t g_buddy_map_off[PHYS_BUDDY_ORDERS];
+static uint32_t g_buddy_map_words[PHYS_BUDDY_ORDERS];
+
+// Section tablosu (NULL = delik, RAM yok) + özet bitmap'ler.
+// Hepsi phys_mem_init'te usable RAM'den kesilir.
+static phys_section_t **g_sections      = NULL;
+static uint64_t         g_section_count = 0;
+static uint64_t         g_max_frame     = 0;    // son usable frame + 1
+static uint64_t         g_alloc_limit   = 0;    // bu frame'den itibaren verilmez
+
+static uint64_t *g_sec_free_map   = NULL;   // [g_sec_map_words]
+static uint64_t *g_sec_free_sum   = NULL;   // [g_sec_sum_words]
+static uint64_t *g_sec_buddy_map  = NULL;   // [order][g_sec_map_words]
+static uint64_t  g_sec_map_words  = 0;
+static uint64_t  g_sec_sum_words  = 0;
+
+static uint64_t g_buddy_free_blocks[PHYS_BUDDY_ORDERS];
+
+// Kesilen metadata aralığı (rezerve edilir)
+static uint64_t g_meta_phys  = 0;
+static uint64_t g_meta_bytes = 0;
+
+// Kernel imajı (frame, dahil)
+static uint64_t g_kernel_first_frame = 0;
+static uint64_t g_kernel_last_frame  = 0;
+
+// ---------------------------------------------------------------------------
+// Geri kazanılabilir boot bölgeleri (BootServices*/Loader*)
+//
+// Memory map'in kendisi de LoaderData içinde durduğu için reclaim
+// zamanında okunamaz; init sırasında bu küçük tabloya kopyalanır.
+// Tablo dolarsa kalan bölgeler sadece kullanılmış olarak kalır.
+// ---------------------------------------------------------------------------
+
+#define PHYS_RECLAIM_MAX_REGIONS   128
+
+typedef struct {
+    uint64_t first_frame;
+    uint64_t frame_count;
+} phys_reclaim_region_t;
+
+static phys_reclaim_region_t g_reclaim_regions[PHYS_RECLAIM_MAX_REGIONS];
+static uint32_t              g_reclaim_count = 0;
+
+// ---------------------------------------------------------------------------
+// RAM aralıkları (usable + reclaimable). Direct map bunlardan kurulur;
+// bitişik descriptor'lar birleştirilir. Tablo dolarsa son aralık
+// genişletilir (aradaki delik de map'lenir, RAM dışarıda kalmaz).
+// ---------------------------------------------------------------------------
+
+#define PHYS_RAM_MAX_RANGES   128
+
+typedef struct {
+    uint64_t start;
+    uint64_t end;
+} phys_ram_range_t;
+
+static phys_ram_range_t g_ram_ranges[PHYS_RAM_MAX_RANGES];
+static uint32_t         g_ram_range_count = 0;
+
 static uint64_t g_total_frames = 0;
 static uint64_t g_free_frames  = 0;
 
-// Son alloc arama başlangıcı (performans için)
-static uint64_t g_last_alloc_search_idx = 0;
+
+// ---------------------------------------------------------------------------
+// Per-CPU frame magazine'leri
+//
+// Magazine'deki frame'ler bitmap'te "used" görünür; g_free_frames yalnızca
+// global havuzu sayar, phys_get_free_frames() ikisini toplar.
+// Bu yüzden phys_free_frame'in bitmap kontrolü, henüz magazine'de duran
+// bir frame'in ikinci kez free edilmesini yakalayamaz; AYKEN_PHYS_DEBUG
+// açıkken magazine'ler ayrıca taranır.
+// Fast path yalnızca kesmeleri kapatır (aynı CPU'da reentrancy), atomik
+// işlem yapmaz. Her magazine ayrı cache line'da durur.
+// ---------------------------------------------------------------------------
+
+#define PHYS_MAG_SIZE    64     // magazine kapasitesi
+#define PHYS_MAG_BATCH   32     // refill/drain başına taşınan frame sayısı
+
+typedef struct {
+    uint64_t count;
+    uint64_t frames[PHYS_MAG_SIZE];
+} __attribute__((aligned(64))) phys_magazine_t;
+
+static phys_magazine_t g_phys_mag[AYKEN_MAX_CPUS];
+
+// Global bitmap + buddy + sayaçlar için (slow path)
+static spinlock_t g_phys_lock = SPINLOCK_INIT;
 
 
 // ---------------------------------------------------------------------------
-// Bitmap yardımcı fonksiyonları (eski haliyle KORUNDU)
+// Section / bitmap yardımcı fonksiyonları
 // ---------------------------------------------------------------------------
 
+static inline uint64_t addr_to_frame_idx(uint64_t phys_addr)
+{
+    return phys_addr / AYKEN_FRAME_SIZE;
+}
+
+static inline uint64_t frame_idx_to_addr(uint64_t idx)
+{
+    return idx * AYKEN_FRAME_SIZE;
+}
+
+static inline uint64_t frame_local(uint64_t frame_idx)
+{
+    return frame_idx & (PHYS_SECTION_FRAMES - 1);
+}
+
+// Frame'in section'ı; aralık dışı veya delik ise NULL
+static inline phys_section_t *frame_section(uint64_t frame_idx)
+{
+    uint64_t s = frame_idx / PHYS_SECTION_FRAMES;
+    if (s >= g_section_count)
+        return NULL;
+    return g_sections[s];
+}
+
+static inline void bit_set(uint64_t *map, uint64_t bit, int value)
+{
+    if (value)
+        map[bit / 64] |= (1ULL << (bit % 64));
+    else
+        map[bit / 64] &= ~(1ULL << (bit % 64));
+}
+
+// Section'ın "boş frame var" bitini global özetlere yansıt
+static inline void section_summary_update(phys_section_t *sec)
+{
+    int has_free = 0;
+    for (uint64_t i = 0; i < PHYS_SECTION_SUM_WORDS; ++i)
+        has_free |= (sec->sum[i] != 0);
+
+    bit_set(g_sec_free_map, sec->index, has_free);
+    bit_set(g_sec_free_sum, sec->index / 64,
+            g_sec_free_map[sec->index / 64] != 0);
+}
+
+// word değişti → özet bitlerini güncelle
+static inline void frame_summary_update(phys_section_t *sec, uint64_t word_idx)
+{
+    uint64_t before = sec->sum[word_idx / 64];
+
+    bit_set(sec->sum, word_idx, sec->bitmap[word_idx] != ~0ULL);
+
+    if ((before != 0) != (sec->sum[word_idx / 64] != 0))
+        section_summary_update(sec);
+}
+
 static inline void frame_set(uint64_t frame_idx)
 {
-    g_frame_bitmap[frame_idx / 8] |= (1u << (frame_idx % 8));
+    phys_section_t *sec = frame_section(frame_idx);
+    uint64_t local = frame_local(frame_idx);
+
+    sec->bitmap[local / 64] |= (1ULL << (local % 64));
+    sec->free_frames--;
+
+    if (sec->bitmap[local / 64] == ~0ULL)
+        frame_summary_update(sec, local / 64);
 }
 
 static inline void frame_clear(uint64_t frame_idx)
 {
-    g_frame_bitmap[frame_idx / 8] &= ~(1u << (frame_idx % 8));
+    phys_section_t *sec = frame_section(frame_idx);
+    uint64_t local = frame_local(frame_idx);
+
+    sec->bitmap[local / 64] &= ~(1ULL << (local % 64));
+    sec->free_frames++;
+    frame_summary_update(sec, local / 64);
+}
+
+// map içinde [start, end) bitlerini value yap; değişen bit sayısını döner.
+// Baş/son kısmi word'ler maskeyle, aradaki tam word'ler tek store ile yazılır.
+static uint64_t bits_range_assign(uint64_t *map, uint64_t start, uint64_t end, int value)
+{
+    if (start >= end)
+        return 0;
+
+    uint64_t w    = start / 64;
+    uint64_t last = (end - 1) / 64;
+    uint64_t head = ~0ULL << (start % 64);
+    uint64_t tail = ~0ULL >> (63 - ((end - 1) % 64));
+    uint64_t changed = 0;
+
+    if (w == last)
+        head &= tail;
+
+    uint64_t old = map[w];
+    map[w] = value ? (old | head) : (old & ~head);
+    changed += (uint64_t)__builtin_popcountll(old ^ map[w]);
+
+    if (w == last)
+        return changed;
+
+    uint64_t fill = value ? ~0ULL : 0;
+    for (++w; w < last; ++w) {
+        changed += (uint64_t)__builtin_popcountll(map[w] ^ fill);
+        map[w] = fill;
+    }
+
+    old = map[last];
+    map[last] = value ? (old | tail) : (old & ~tail);
+    changed += (uint64_t)__builtin_popcountll(old ^ map[last]);
+
+    return changed;
+}
+
+// [first, end) frame aralığını used (1) / free (0) olarak işaretle.
+// Section başına bitmap word'leri toplu yazılır, özetler bir kez
+// güncellenir; delik section'lar atlanır. Zaten hedef durumdaki frame'ler
+// sayılmaz (çakışan descriptor'lar) → durum değiştiren frame sayısı döner.
+static uint64_t frame_range_mark(uint64_t first, uint64_t end, int used)
+{
+    if (end > g_max_frame)
+        end = g_max_frame;
+
+    uint64_t total = 0;
+
+    while (first < end) {
+        uint64_t s       = first / PHYS_SECTION_FRAMES;
+        uint64_t sec_end = (s + 1) * PHYS_SECTION_FRAMES;
+        uint64_t stop    = end < sec_end ? end : sec_end;
+        phys_section_t *sec = g_sections[s];
+
+        if (sec) {
+            uint64_t l0 = frame_local(first);
+            uint64_t l1 = l0 + (stop - first);
+            uint64_t changed = bits_range_assign(sec->bitmap, l0, l1, used);
+
+            if (used)
+                sec->free_frames -= changed;
+            else
+                sec->free_frames += changed;
+            total += changed;
+
+            // Özet: aradaki tam word'ler doğrudan, kenar word'ler yeniden hesap
+            uint64_t w0 = l0 / 64;
+            uint64_t w1 = (l1 - 1) / 64;
+            if (w1 > w0 + 1)
+                bits_range_assign(sec->sum, w0 + 1, w1, !used);
+            bit_set(sec->sum, w0, sec->bitmap[w0] != ~0ULL);
+            bit_set(sec->sum, w1, sec->bitmap[w1] != ~0ULL);
+            section_summary_update(sec);
+        }
+
+        first = stop;
+    }
+
+    return total;
+}
+
+// [first, end) içindeki used frame sayısı (delikler sayılmaz)
+static uint64_t frame_range_count_used(uint64_t first, uint64_t end)
+{
+    uint64_t used = 0;
+
+    while (first < end) {
+        uint64_t s       = first / PHYS_SECTION_FRAMES;
+        uint64_t sec_end = (s + 1) * PHYS_SECTION_FRAMES;
+        uint64_t stop    = end < sec_end ? end : sec_end;
+        phys_section_t *sec = frame_section(first);
+
+        if (sec) {
+            uint64_t l0 = frame_local(first);
+            uint64_t l1 = l0 + (stop - first);
+
+            while (l0 < l1) {
+                uint64_t w    = l0 / 64;
+                uint64_t bits = (l1 - l0) < (64 - l0 % 64) ? (l1 - l0) : (64 - l0 % 64);
+                uint64_t mask = (bits == 64 ? ~0ULL : ((1ULL << bits) - 1)) << (l0 % 64);
+                used += (uint64_t)__builtin_popcountll(sec->bitmap[w] & mask);
+                l0 += bits;
+            }
+        }
+
+        first = stop;
+    }
+
+    return used;
 }
 
+// Delik/aralık dışı frame'ler "used" sayılır
 static inline int frame_test(uint64_t frame_idx)
 {
-    return (g_frame_bitmap[frame_idx / 8] >> (frame_idx % 8)) & 1u;
+    phys_section_t *sec = frame_section(frame_idx);
+    if (!sec)
+        return 1;
+
+    uint64_t local = frame_local(frame_idx);
+    return (sec->bitmap[local / 64] >> (local % 64)) & 1u;
 }
 
-static inline uint64_t addr_to_frame_idx(uint64_t phys_addr)
+// En düşük adresli boş frame: her seviyede tek tzcnt, bulunamazsa ~0
+static inline uint64_t frame_find_free(void)
 {
-    return phys_addr / AYKEN_FRAME_SIZE;
+    for (uint64_t w = 0; w < g_sec_sum_words; ++w) {
+        if (!g_sec_free_sum[w])
+            continue;
+
+        uint64_t mw = w * 64 + (uint64_t)__builtin_ctzll(g_sec_free_sum[w]);
+        uint64_t s  = mw * 64 + (uint64_t)__builtin_ctzll(g_sec_free_map[mw]);
+        phys_section_t *sec = g_sections[s];
+
+        for (uint64_t i = 0; i < PHYS_SECTION_SUM_WORDS; ++i) {
+            if (!sec->sum[i])
+                continue;
+
+            uint64_t bw = i * 64 + (uint64_t)__builtin_ctzll(sec->sum[i]);
+            uint64_t local = bw * 64 + (uint64_t)__builtin_ctzll(~sec->bitmap[bw]);
+            return s * PHYS_SECTION_FRAMES + local;
+        }
+    }
+
+    return ~0ULL;
 }
 
-static inline uint64_t frame_idx_to_addr(uint64_t idx)
+
+// ---------------------------------------------------------------------------
+// Buddy yardımcıları (blok indeksleri section içi, frame'ler global)
+// ---------------------------------------------------------------------------
+
+static inline uint64_t *buddy_words(phys_section_t *sec, uint32_t order)
 {
-    return idx * AYKEN_FRAME_SIZE;
+    return &sec->buddy[g_buddy_map_off[order]];
 }
 
-// Tüm frame’leri “dolu” olarak işaretle, sonra usable RAM açılacak
-static void bitmap_mark_all_used(void)
+static inline uint64_t *sec_buddy_map(uint32_t order)
 {
-    for (uint64_t i = 0; i < (AYKEN_MAX_FRAMES / 8); ++i)
-        g_frame_bitmap[i] = 0xFF;
+    return &g_sec_buddy_map[order * g_sec_map_words];
+}
 
-    g_total_frames = 0;
-    g_free_frames  = 0;
+static inline int buddy_test(phys_section_t *sec, uint32_t order, uint64_t blk)
+{
+    if ((blk / 64) >= g_buddy_map_words[order])
+        return 0;
+    return (buddy_words(sec, order)[blk / 64] >> (blk % 64)) & 1u;
+}
+
+static inline void buddy_mark_free(phys_section_t *sec, uint32_t order, uint64_t blk)
+{
+    buddy_words(sec, order)[blk / 64] |= (1ULL << (blk % 64));
+    g_buddy_free_blocks[order]++;
+
+    if (sec->buddy_free[order]++ == 0)
+        bit_set(sec_buddy_map(order), sec->index, 1);
+
+    if ((blk / 64) < sec->buddy_hint[order])
+        sec->buddy_hint[order] = (uint32_t)(blk / 64);
+}
+
+static inline void buddy_mark_taken(phys_section_t *sec, uint32_t order, uint64_t blk)
+{
+    buddy_words(sec, order)[blk / 64] &= ~(1ULL << (blk % 64));
+    g_buddy_free_blocks[order]--;
+
+    if (--sec->buddy_free[order] == 0)
+        bit_set(sec_buddy_map(order), sec->index, 0);
+}
+
+static void buddy_layout_init(void)
+{
+    uint32_t off = 0;
+
+    for (uint32_t o = 0; o < PHYS_BUDDY_ORDERS; ++o) {
+        g_buddy_map_off[o]     = off;
+        g_buddy_map_words[o]   = (uint32_t)(((PHYS_SECTION_FRAMES >> o) + 63) / 64);
+        g_buddy_free_blocks[o] = 0;
+        off += g_buddy_map_words[o];
+    }
+}
+
+// Bloğu free listeye ekle; buddy'si de boşsa yukarı doğru birleştir.
+static void buddy_insert(uint64_t frame_idx, uint32_t order)
+{
+    phys_section_t *sec = frame_section(frame_idx);
+    uint64_t blk = frame_local(frame_idx) >> order;
+
+    while (order < PHYS_BUDDY_MAX_ORDER && buddy_test(sec, order, blk ^ 1)) {
+        buddy_mark_taken(sec, order, blk ^ 1);
+        blk >>= 1;
+        order++;
+    }
+
+    buddy_mark_free(sec, order, blk);
+}
+
+// [start, end) aralığını hizalı en büyük bloklara bölerek ekle
+static void buddy_insert_range(uint64_t start, uint64_t end)
+{
+    while (start < end) {
+        uint32_t order = 0;
+
+        while (order < PHYS_BUDDY_MAX_ORDER &&
+               (start & ((1ULL << (order + 1)) - 1)) == 0 &&
+               start + (1ULL << (order + 1)) <= end)
+            order++;
+
+        buddy_insert(start, order);
+        start += (1ULL << order);
+    }
+}
+
+// Section içinde verilen order'daki ilk boş bloğu bul
+static uint64_t buddy_find(phys_section_t *sec, uint32_t order)
+{
+    uint64_t *words = buddy_words(sec, order);
+
+    for (uint64_t w = sec->buddy_hint[order]; w < g_buddy_map_words[order]; ++w) {
+        if (words[w]) {
+            sec->buddy_hint[order] = (uint32_t)w;
+            return w * 64 + (uint64_t)__builtin_ctzll(words[w]);
+        }
+    }
+
+    return PHYS_BUDDY_NONE;
+}
+
+// Bu order'da boş bloğu olan ilk section
+static phys_section_t *buddy_find_section(uint32_t order)
+{
+    uint64_t *map = sec_buddy_map(order);
+
+    for (uint64_t w = 0; w < g_sec_map_words; ++w) {
+        if (map[w])
+            return g_sections[w * 64 + (uint64_t)__builtin_ctzll(map[w])];
+    }
+
+    return NULL;
+}
+
+// 2^order frame'lik blok ayır; gerekirse üst order'ı ikiye böl
+static uint64_t buddy_take(uint32_t order)
+{
+    // Her order'ın en düşük section'ı; pencere dışındaysa bir üst order
+    phys_section_t *sec = NULL;
+    uint32_t o = order;
+    for (; o <= PHYS_BUDDY_MAX_ORDER; ++o) {
+        if (g_buddy_free_blocks[o] == 0)
+            continue;
+
+        sec = buddy_find_section(o);
+        if (sec && sec->index * PHYS_SECTION_FRAMES < g_alloc_limit)
+            break;
+        sec = NULL;
+    }
+
+    if (!sec)
+        return PHYS_BUDDY_NONE;
+
+    uint64_t blk = buddy_find(sec, o);
+    if (blk == PHYS_BUDDY_NONE)
+        return PHYS_BUDDY_NONE;
+
+    buddy_mark_taken(sec, o, blk);
+
+    // Alt order'lara inerken sağ yarıları free bırak
+    while (o > order) {
+        o--;
+        blk <<= 1;
+        buddy_mark_free(sec, o, blk | 1);
+    }
+
+    return sec->index * PHYS_SECTION_FRAMES + (blk << order);
+}
+
+// Tek frame'i (bitmap yolu ile seçilmiş) içeren buddy bloğundan kopar
+static void buddy_carve(uint64_t frame_idx)
+{
+    phys_section_t *sec = frame_section(frame_idx);
+    uint64_t local = frame_local(frame_idx);
+
+    uint32_t o = 0;
+    while (o <= PHYS_BUDDY_MAX_ORDER && !buddy_test(sec, o, local >> o))
+        o++;
+
+    if (o > PHYS_BUDDY_MAX_ORDER)
+        return; // buddy'de yok (olmamalı)
+
+    buddy_mark_taken(sec, o, local >> o);
+
+    while (o > 0) {
+        o--;
+        buddy_mark_free(sec, o, (local >> o) ^ 1);
+    }
+}
+
+// Frame zaten bir buddy bloğunun içinde mi?
+static int buddy_covers(uint64_t frame_idx)
+{
+    phys_section_t *sec = frame_section(frame_idx);
+    uint64_t local = frame_local(frame_idx);
+
+    for (uint32_t o = 0; o <= PHYS_BUDDY_MAX_ORDER; ++o) {
+        if (buddy_test(sec, o, local >> o))
+            return 1;
+    }
+
+    return 0;
+}
+
+// Bitmap'teki boş koşulardan buddy yapısını sıfırdan kur.
+// Word bazında tarar: tamamen dolu word'ler tek karşılaştırmayla geçilir,
+// koşu sınırları tzcnt ile bulunur.
+static void buddy_build_from_bitmap(void)
+{
+    for (uint64_t s = 0; s < g_section_count; ++s) {
+        phys_section_t *sec = g_sections[s];
+        if (!sec || !sec->free_frames)
+            continue;
+
+        uint64_t base      = s * PHYS_SECTION_FRAMES;
+        uint64_t run_start = 0;
+        int      in_run    = 0;
+
+        for (uint64_t w = 0; w < PHYS_SECTION_WORDS; ++w) {
+            uint64_t word = sec->bitmap[w];
+
+            // Koşunun devam ettiği/başlamadığı hızlı durumlar
+            if ((in_run && word == 0) || (!in_run && word == ~0ULL))
+                continue;
+
+            uint64_t bit = 0;
+            while (bit < 64) {
+                // Bu noktadan sonra durumun değiştiği ilk bit
+                uint64_t rest = (in_run ? word : ~word) >> bit;
+                if (!rest)
+                    break;
+
+                bit += (uint64_t)__builtin_ctzll(rest);
+                if (in_run) {
+                    buddy_insert_range(run_start, base + w * 64 + bit);
+                    in_run = 0;
+                } else {
+                    run_start = base + w * 64 + bit;
+                    in_run = 1;
+                }
+            }
+        }
+
+        if (in_run)
+            buddy_insert_range(run_start, base + PHYS_SECTION_FRAMES);
+    }
+}
+
+static inline uint32_t buddy_order_for(uint64_t count)
+{
+    uint32_t order = 0;
+    while ((1ULL << order) < count)
+        order++;
+    return order;
+}
+
+
+
+// ===========================================================================
+//  FRAME VERİTABANI KURULUMU (section tablosu + metadata)
+// ===========================================================================
+
+static inline uint64_t align_up_u64(uint64_t x, uint64_t a)
+{
+    return (x + a - 1) & ~(a - 1);
+}
+
+static inline int efi_region_usable(const ayken_efi_mmap_entry_t *ent)
+{
+    return ent->type == AYKEN_EFI_MEM_CONVENTIONAL && ent->num_pages != 0;
+}
+
+// Boot bittikten sonra allocator'a dönebilecek bölgeler
+static inline int efi_region_reclaimable(const ayken_efi_mmap_entry_t *ent)
+{
+    if (ent->num_pages == 0)
+        return 0;
+
+    return ent->type == AYKEN_EFI_MEM_LOADER_CODE ||
+           ent->type == AYKEN_EFI_MEM_LOADER_DATA ||
+           ent->type == AYKEN_EFI_MEM_BS_CODE     ||
+           ent->type == AYKEN_EFI_MEM_BS_DATA;
+}
+
+// Frame veritabanının kapsaması gereken RAM (hemen ya da reclaim sonrası)
+static inline int efi_region_is_ram(const ayken_efi_mmap_entry_t *ent)
+{
+    return efi_region_usable(ent) || efi_region_reclaimable(ent);
+}
+
+static inline ayken_efi_mmap_entry_t *efi_entry(void *map, uint64_t desc_size,
+                                                uint64_t i)
+{
+    return (ayken_efi_mmap_entry_t *)((uint8_t *)map + i * desc_size);
+}
+
+// Section [s * 128MiB, (s+1) * 128MiB) herhangi bir RAM bölgesine değiyor mu?
+static int section_has_ram(void *map, uint64_t desc_size, uint64_t desc_count,
+                           uint64_t s)
+{
+    uint64_t sec_start = s * PHYS_SECTION_FRAMES;
+    uint64_t sec_end   = sec_start + PHYS_SECTION_FRAMES;
+
+    for (uint64_t i = 0; i < desc_count; ++i) {
+        ayken_efi_mmap_entry_t *ent = efi_entry(map, desc_size, i);
+        if (!efi_region_is_ram(ent))
+            continue;
+
+        uint64_t first = addr_to_frame_idx(ent->phys_start);
+        uint64_t end   = first + ent->num_pages;
+
+        if (first < sec_end && end > sec_start)
+            return 1;
+    }
+
+    return 0;
+}
+
+// 'bytes' kadar metadata için, higher-half penceresinden erişilebilen,
+// kernel ve ilk 1MB ile çakışmayan usable bir aralık seç.
+static uint64_t find_meta_region(void *map, uint64_t desc_size,
+                                 uint64_t desc_count, uint64_t bytes,
+                                 uint64_t kernel_phys_start,
+                                 uint64_t kernel_phys_end)
+{
+    for (uint64_t i = 0; i < desc_count; ++i) {
+        ayken_efi_mmap_entry_t *ent = efi_entry(map, desc_size, i);
+        if (!efi_region_usable(ent))
+            continue;
+
+        uint64_t start = ent->phys_start;
+        uint64_t end   = start + ent->num_pages * AYKEN_FRAME_SIZE;
+
+        if (start < 0x100000ULL)
+            start = 0x100000ULL;
+        if (end > PHYS_META_LIMIT)
+            end = PHYS_META_LIMIT;
+
+        // Kernel bölgeyle çakışıyorsa kernel'in üstündeki parçayı dene
+        if (start < kernel_phys_end && end > kernel_phys_start)
+            start = align_up_u64(kernel_phys_end, AYKEN_FRAME_SIZE);
+
+        if (start < end && end - start >= bytes)
+            return start;
+    }
+
+    return 0;
+}
+
+// Section tablosunu, özet bitmap'leri ve section metadata'sını kur.
+// @return 0 başarı, -1 uygun alan yok
+static int phys_db_init(void *map, uint64_t desc_size, uint64_t desc_count,
+                        uint64_t kernel_phys_start, uint64_t kernel_phys_end)
+{
+    // 1) En yüksek RAM frame'i (reclaim edilecekler dahil) → section sayısı
+    g_max_frame = 0;
+    for (uint64_t i = 0; i < desc_count; ++i) {
+        ayken_efi_mmap_entry_t *ent = efi_entry(map, desc_size, i);
+        if (!efi_region_is_ram(ent))
+            continue;
+
+        uint64_t end = addr_to_frame_idx(ent->phys_start) + ent->num_pages;
+        if (end > g_max_frame)
+            g_max_frame = end;
+    }
+
+    g_section_count = (g_max_frame + PHYS_SECTION_FRAMES - 1) / PHYS_SECTION_FRAMES;
+    g_sec_map_words = (g_section_count + 63) / 64;
+    g_sec_sum_words = (g_sec_map_words + 63) / 64;
+
+    uint64_t present = 0;
+    for (uint64_t s = 0; s < g_section_count; ++s)
+        present += (uint64_t)section_has_ram(map, desc_size, desc_count, s);
+
+    // 2) Metadata boyutu: section'lar + pointer tablosu + özet bitmap'ler
+    uint64_t sec_bytes = present * sizeof(phys_section_t);
+    uint64_t ptr_bytes = align_up_u64(g_section_count * sizeof(phys_section_t *), 64);
+    uint64_t map_bytes = (g_sec_map_words * (1 + PHYS_BUDDY_ORDERS) +
+                          g_sec_sum_words) * sizeof(uint64_t);
+
+    g_meta_bytes = align_up_u64(sec_bytes + ptr_bytes + map_bytes, AYKEN_FRAME_SIZE);
+    g_meta_phys  = find_meta_region(map, desc_size, desc_count, g_meta_bytes,
+                                    kernel_phys_start, kernel_phys_end);
+    if (!g_meta_phys)
+        return -1;
+
+    // 3) Kes + sıfırla
+    uint8_t *meta = (uint8_t *)paging_phys_to_virt(g_meta_phys);
+    uint64_t *meta_words = (uint64_t *)meta;
+    for (uint64_t i = 0; i < g_meta_bytes / sizeof(uint64_t); ++i)
+        meta_words[i] = 0;
+
+    phys_section_t *secs = (phys_section_t *)meta;
+    g_sections      = (phys_section_t **)(meta + sec_bytes);
+    g_sec_free_map  = (uint64_t *)(meta + sec_bytes + ptr_bytes);
+    g_sec_free_sum  = g_sec_free_map + g_sec_map_words;
+    g_sec_buddy_map = g_sec_free_sum + g_sec_sum_words;
+
+    buddy_layout_init();
+
+    // 4) RAM içeren section'lar: başlangıçta tamamı "used"
+    uint64_t next = 0;
+    for (uint64_t s = 0; s < g_section_count; ++s) {
+        if (!section_has_ram(map, desc_size, desc_count, s))
+            continue;
+
+        phys_section_t *sec = &secs[next++];
+        for (uint64_t w = 0; w < PHYS_SECTION_WORDS; ++w)
+            sec->bitmap[w] = ~0ULL;
+        sec->index = s;
+        sec->free_frames = 0;
+        g_sections[s] = sec;
+    }
+
+    return 0;
 }
 
 
@@ -95,66 +835,115 @@ void phys_mem_init(void *efi_mem_map,
 {
     fb_print("[phys_mem] Initializing physical memory manager...\n");
 
-    // 1) Tüm frame’leri kapalı (used) yap
-    bitmap_mark_all_used();
+    spin_lock_init(&g_phys_lock);
+    for (uint32_t c = 0; c < AYKEN_MAX_CPUS; ++c)
+        g_phys_mag[c].count = 0;
+
+    g_total_frames = 0;
+    g_free_frames  = 0;
 
-    uint8_t *mmap_ptr = (uint8_t *)efi_mem_map;
+    // 1) Frame veritabanını memory map'e göre boyutlandır (tümü "used")
+    if (phys_db_init(efi_mem_map, desc_size, desc_count,
+                     kernel_phys_start, kernel_phys_end) != 0) {
+        fb_print("[phys_mem] ERROR: no room for frame database.\n");
+        return;
+    }
 
     // 2) UEFI memory map içindeki usable bölgeleri free olarak işaretle
     for (uint64_t i = 0; i < desc_count; ++i) {
 
-        ayken_efi_mmap_entry_t *ent =
-            (ayken_efi_mmap_entry_t *)(mmap_ptr + i * desc_size);
+        ayken_efi_mmap_entry_t *ent = efi_entry(efi_mem_map, desc_size, i);
 
-        if (ent->type != AYKEN_EFI_MEM_CONVENTIONAL)
+        if (!efi_region_usable(ent))
             continue;
 
-        uint64_t region_start = ent->phys_start;
-        uint64_t region_size  = ent->num_pages * 4096ULL;
-        uint64_t region_end   = region_start + region_size;
+        uint64_t first_frame = addr_to_frame_idx(ent->phys_start);
 
-        // 4GB sınırı dışını yok say
-        if (region_start >= AYKEN_MAX_PHYS_MEM)
-            continue;
-        if (region_end > AYKEN_MAX_PHYS_MEM)
-            region_end = AYKEN_MAX_PHYS_MEM;
-
-        uint64_t first_frame = addr_to_frame_idx(region_start);
-        uint64_t last_frame  = addr_to_frame_idx(region_end - 1);
-
-        // Bölgedeki tüm frame’leri free yap
-        for (uint64_t f = first_frame; f <= last_frame && f < AYKEN_MAX_FRAMES; ++f) {
-            frame_clear(f);   // 0 = free
-            g_total_frames++;
-            g_free_frames++;
-        }
+        // Bölgedeki tüm frame’leri free yap (çakışan descriptor'lar
+        // frame_range_mark tarafından iki kez sayılmaz)
+        uint64_t n = frame_range_mark(first_frame, first_frame + ent->num_pages, 0);
+        g_total_frames += n;
+        g_free_frames  += n;
     }
 
     // 3) Kernel’in fiziksel adres aralığını rezerve et
     uint64_t k_start_frame = addr_to_frame_idx(kernel_phys_start);
     uint64_t k_end_frame   = addr_to_frame_idx(kernel_phys_end - 1);
 
-    for (uint64_t f = k_start_frame; f <= k_end_frame && f < AYKEN_MAX_FRAMES; ++f) {
-        if (!frame_test(f)) {
-            frame_set(f);
-            g_free_frames--;
-        }
-    }
+    g_kernel_first_frame = k_start_frame;
+    g_kernel_last_frame  = k_end_frame;
+
+    g_free_frames -= frame_range_mark(k_start_frame, k_end_frame + 1, 1);
 
     // 4) İlk 1MB’yi rezerve et (BIOS, APIC, EBDA vb.)
-    for (uint64_t f = 0; f < addr_to_frame_idx(0x100000ULL); ++f) {
-        if (!frame_test(f)) {
-            frame_set(f);
-            g_free_frames--;
+    g_free_frames -= frame_range_mark(0, addr_to_frame_idx(0x100000ULL), 1);
+
+    // 5) Frame veritabanının kendisini rezerve et
+    uint64_t m_start_frame = addr_to_frame_idx(g_meta_phys);
+    uint64_t m_end_frame   = m_start_frame + g_meta_bytes / AYKEN_FRAME_SIZE;
+
+    g_free_frames -= frame_range_mark(m_start_frame, m_end_frame, 1);
+
+    // 6) Son bitmap'ten buddy free bloklarını kur
+    buddy_build_from_bitmap();
+
+    // Direct map'e kadar yalnızca boot penceresindeki frame'ler verilir
+    g_alloc_limit = addr_to_frame_idx(PHYS_META_LIMIT);
+
+    // 7) Boot sonrası geri alınacak bölgeleri kaydet
+    g_reclaim_count = 0;
+    for (uint64_t i = 0; i < desc_count; ++i) {
+        ayken_efi_mmap_entry_t *ent = efi_entry(efi_mem_map, desc_size, i);
+
+        if (!efi_region_reclaimable(ent))
+            continue;
+        if (g_reclaim_count == PHYS_RECLAIM_MAX_REGIONS) {
+            fb_print("[phys_mem] WARNING: reclaim table full, some boot memory stays reserved.\n");
+            break;
         }
+
+        g_reclaim_regions[g_reclaim_count].first_frame = addr_to_frame_idx(ent->phys_start);
+        g_reclaim_regions[g_reclaim_count].frame_count = ent->num_pages;
+        g_reclaim_count++;
     }
 
-    g_last_alloc_search_idx = 0;
+    // 8) Direct map için RAM aralıkları (memory map sonradan okunamaz)
+    g_ram_range_count = 0;
+    for (uint64_t i = 0; i < desc_count; ++i) {
+        ayken_efi_mmap_entry_t *ent = efi_entry(efi_mem_map, desc_size, i);
+
+        if (!efi_region_is_ram(ent))
+            continue;
+
+        uint64_t start = ent->phys_start;
+        uint64_t end   = start + ent->num_pages * AYKEN_FRAME_SIZE;
+        phys_ram_range_t *last = g_ram_range_count ? &g_ram_ranges[g_ram_range_count - 1] : NULL;
+
+        if (last && start <= last->end && end >= last->start) {
+            if (start < last->start) last->start = start;
+            if (end > last->end)     last->end   = end;
+            continue;
+        }
+        if (g_ram_range_count == PHYS_RAM_MAX_RANGES) {
+            fb_print("[phys_mem] WARNING: RAM range table full, merging into last range.\n");
+            if (end > last->end)
+                last->end = end;
+            continue;
+        }
+
+        g_ram_ranges[g_ram_range_count].start = start;
+        g_ram_ranges[g_ram_range_count].end   = end;
+        g_ram_range_count++;
+    }
 
     fb_print("[phys_mem] total frames: ");
-    fb_print_hex64(g_total_frames);
+    fb_print_uint(g_total_frames);
     fb_print(", free: ");
-    fb_print_hex64(g_free_frames);
+    fb_print_uint(g_free_frames);
+    fb_print(", sections: ");
+    fb_print_uint(g_section_count);
+    fb_print(", metadata bytes: ");
+    fb_print_uint(g_meta_bytes);
     fb_print("\n");
 
     fb_print("[phys_mem] init done.\n");
@@ -163,134 +952,553 @@ void phys_mem_init(void *efi_mem_map,
 
 
 // ===========================================================================
-//  TEK FRAME ALLOCATION (eski sürüm — korunarak bırakıldı)
+//  TEK FRAME ALLOCATION (özet bitmap + tzcnt, en kötü durum sınırlı)
+//  *_locked fonksiyonları g_phys_lock tutulurken çağrılır.
 // ===========================================================================
 
-uint64_t phys_alloc_frame(void)
+static uint64_t phys_alloc_frame_locked(void)
 {
     if (g_free_frames == 0)
         return 0;
 
-    // 1) Son aramadan itibaren devam
-    for (uint64_t i = g_last_alloc_search_idx; i < AYKEN_MAX_FRAMES; ++i) {
-        if (!frame_test(i)) {
-            frame_set(i);
-            g_free_frames--;
-            g_last_alloc_search_idx = i + 1;
-            return frame_idx_to_addr(i);
-        }
+    // En düşük boş frame pencerenin dışındaysa altında boş frame yok
+    uint64_t i = frame_find_free();
+    if (i >= g_max_frame || i >= g_alloc_limit)
+        return 0; // OOM
+
+    frame_set(i);
+    buddy_carve(i);
+    g_free_frames--;
+    return frame_idx_to_addr(i);
+}
+
+static void phys_free_frame_locked(uint64_t idx)
+{
+    if (frame_test(idx)) {
+        frame_clear(idx);
+        buddy_insert(idx, 0);
+        g_free_frames++;
+    }
+}
+
+// Global havuzdan PHYS_MAG_BATCH frame çek
+static void phys_mag_refill(phys_magazine_t *mag)
+{
+    spin_lock(&g_phys_lock);
+
+    while (mag->count < PHYS_MAG_BATCH) {
+        uint64_t phys = phys_alloc_frame_locked();
+        if (!phys)
+            break;
+        mag->frames[mag->count++] = phys;
     }
 
-    // 2) Baştan bir daha tarayalım
-    for (uint64_t i = 0; i < g_last_alloc_search_idx; ++i) {
-        if (!frame_test(i)) {
-            frame_set(i);
-            g_free_frames--;
-            g_last_alloc_search_idx = i + 1;
-            return frame_idx_to_addr(i);
+    spin_unlock(&g_phys_lock);
+}
+
+// Magazine'den en fazla 'n' frame'i global havuza geri ver
+static void phys_mag_drain(phys_magazine_t *mag, uint64_t n)
+{
+    spin_lock(&g_phys_lock);
+
+    while (n-- && mag->count)
+        phys_free_frame_locked(addr_to_frame_idx(mag->frames[--mag->count]));
+
+    spin_unlock(&g_phys_lock);
+}
+
+#if AYKEN_PHYS_DEBUG
+// Frame herhangi bir CPU'nun magazine'inde mi? (kilitsiz, yalnızca debug)
+static int phys_mag_contains(uint64_t phys)
+{
+    for (uint32_t c = 0; c < AYKEN_MAX_CPUS; ++c) {
+        const phys_magazine_t *mag = &g_phys_mag[c];
+        for (uint64_t i = 0; i < mag->count; ++i) {
+            if (mag->frames[i] == phys)
+                return 1;
         }
     }
+    return 0;
+}
+#endif
+
+uint64_t phys_alloc_frame(void)
+{
+    return phys_alloc_frame_at(MM_STATS_CALLER);
+}
+
+uint64_t phys_alloc_frame_at(void *site)
+{
+    (void)site;
+
+    uint64_t flags = cpu_irq_save();
+    phys_magazine_t *mag = &g_phys_mag[cpu_current_id()];
+
+    if (mag->count == 0)
+        phys_mag_refill(mag);
+
+    uint64_t phys = mag->count ? mag->frames[--mag->count] : 0;
+
+    cpu_irq_restore(flags);
+
+    if (phys)
+        MM_STATS_ALLOC_AT(MM_STAT_FRAME, site, AYKEN_FRAME_SIZE);
+    return phys;
+}
+
+// ---------------------------------------------------------------------------
+// Paylaşımlı frame referansları (COW)
+//
+// Ayrılmış her frame'in örtük tek sahibi vardır; refs yalnızca ek
+// sahipleri sayar, yani paylaşılmayan frame'ler için hep 0 kalır.
+// phys_free_frame önce ek sahip düşürür, frame'i ancak son sahip bırakır.
+// Sayaçlar atomik: free yolu g_phys_lock almadan çalışır.
+// ---------------------------------------------------------------------------
+
+#define PHYS_REFS_MAX   0xFFFF
+
+// Ek sahip varsa birini düşürür; 1 → frame hâlâ kullanımda
+static inline int frame_ref_drop(phys_section_t *sec, uint64_t local)
+{
+    uint16_t *r = &sec->refs[local];
+    uint16_t  v = __atomic_load_n(r, __ATOMIC_RELAXED);
+
+    while (v) {
+        if (__atomic_compare_exchange_n(r, &v, (uint16_t)(v - 1), 1,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            return 1;
+    }
+    return 0;
+}
+
+int phys_frame_ref(uint64_t phys_addr)
+{
+    uint64_t idx = addr_to_frame_idx(phys_addr);
+    phys_section_t *sec = frame_section(idx);
+    if (!sec || !frame_test(idx))
+        return -1;
+
+    uint16_t *r = &sec->refs[frame_local(idx)];
+    uint16_t  v = __atomic_load_n(r, __ATOMIC_RELAXED);
+
+    do {
+        if (v == PHYS_REFS_MAX)
+            return -1;
+    } while (!__atomic_compare_exchange_n(r, &v, (uint16_t)(v + 1), 1,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+    return 0;
+}
+
+uint32_t phys_frame_refcount(uint64_t phys_addr)
+{
+    uint64_t idx = addr_to_frame_idx(phys_addr);
+    phys_section_t *sec = frame_section(idx);
+    if (!sec || !frame_test(idx))
+        return 0;
+
+    return 1u + __atomic_load_n(&sec->refs[frame_local(idx)], __ATOMIC_ACQUIRE);
+}
 
-    return 0; // OOM
+uint16_t *phys_frame_aux(uint64_t phys_addr)
+{
+    uint64_t idx = addr_to_frame_idx(phys_addr);
+    phys_section_t *sec = frame_section(idx);
+    if (!sec)
+        return NULL;
+
+    return &sec->aux[frame_local(idx)];
 }
 
 void phys_free_frame(uint64_t phys_addr)
 {
     uint64_t idx = addr_to_frame_idx(phys_addr);
-    if (idx >= AYKEN_MAX_FRAMES)
+    phys_section_t *sec = frame_section(idx);
+    if (!sec)
         return;
 
-    if (frame_test(idx)) {
-        frame_clear(idx);
-        g_free_frames++;
+    // Zaten boş frame → yok say (magazine'e iki kez girmesin)
+    if (!frame_test(idx))
+        return;
 
-        if (idx < g_last_alloc_search_idx)
-            g_last_alloc_search_idx = idx;
+#if AYKEN_PHYS_DEBUG
+    if (phys_mag_contains(frame_idx_to_addr(idx))) {
+        fb_print("[phys_mem] ERROR: double free of cached frame ");
+        fb_print_hex(frame_idx_to_addr(idx));
+        fb_print("\n");
+        return;
     }
+#endif
+
+    // Paylaşımlı frame: yalnızca bu sahibin referansı gider
+    if (frame_ref_drop(sec, frame_local(idx)))
+        return;
+
+    MM_STATS_FREE(MM_STAT_FRAME, AYKEN_FRAME_SIZE);
+
+    uint64_t flags = cpu_irq_save();
+    phys_magazine_t *mag = &g_phys_mag[cpu_current_id()];
+
+    if (mag->count == PHYS_MAG_SIZE)
+        phys_mag_drain(mag, PHYS_MAG_BATCH);
+
+    mag->frames[mag->count++] = frame_idx_to_addr(idx);
+
+    cpu_irq_restore(flags);
 }
 
 
 
 // ===========================================================================
-//  YENİ → MULTI-FRAME ALLOCATION (açıklamalı)
+//  YENİ → MULTI-FRAME ALLOCATION (buddy)
 // ===========================================================================
 
+// En büyük buddy bloğunu aşan istekler: boş koşu bitmap'te aranır.
+// Boş frame'i olmayan section'lar (ve delikler) tek karşılaştırmayla,
+// tamamen dolu/boş word'ler tek adımda geçilir; bit bit yalnızca karışık
+// word'lerde, koşu sınırları tzcnt ile bulunur.
+static uint64_t phys_alloc_frames_scan(uint64_t count)
+{
+    uint64_t chain_start = 0;
+    uint64_t chain_len   = 0;
+    uint64_t sec_limit   = (g_alloc_limit + PHYS_SECTION_FRAMES - 1) / PHYS_SECTION_FRAMES;
+
+    if (sec_limit > g_section_count)
+        sec_limit = g_section_count;
+
+    for (uint64_t s = 0; s < sec_limit && chain_len < count; ++s) {
+        phys_section_t *sec = g_sections[s];
+        uint64_t base = s * PHYS_SECTION_FRAMES;
+
+        if (!sec || !sec->free_frames) {
+            chain_len = 0;
+            continue;
+        }
+
+        for (uint64_t w = 0; w < PHYS_SECTION_WORDS && chain_len < count; ++w) {
+            uint64_t word = sec->bitmap[w];
+
+            if (word == ~0ULL) {
+                chain_len = 0;
+                continue;
+            }
+            if (word == 0) {
+                if (chain_len == 0)
+                    chain_start = base + w * 64;
+                chain_len += 64;
+                continue;
+            }
+
+            uint64_t bit = 0;
+            while (bit < 64 && chain_len < count) {
+                uint64_t rest = ~word >> bit;     // boş bitler
+                if (!rest) {
+                    chain_len = 0;
+                    break;
+                }
+
+                uint64_t skip = (uint64_t)__builtin_ctzll(rest);
+                if (skip)
+                    chain_len = 0;
+                bit += skip;
+
+                // bit'ten başlayan boş koşunun uzunluğu
+                uint64_t used = word >> bit;
+                uint64_t run  = used ? (uint64_t)__builtin_ctzll(used) : 64 - bit;
+
+                if (chain_len == 0)
+                    chain_start = base + w * 64 + bit;
+                chain_len += run;
+                bit += run;
+            }
+        }
+    }
+
+    if (chain_len < count || chain_start + count > g_alloc_limit)
+        return 0;
+
+    g_free_frames -= frame_range_mark(chain_start, chain_start + count, 1);
+    for (uint64_t f = chain_start; f < chain_start + count; f++)
+        buddy_carve(f);
+
+    return frame_idx_to_addr(chain_start);
+}
+
+static uint64_t phys_alloc_frames_locked(uint64_t count)
+{
+    if (count > g_free_frames)
+        return 0;
+
+    if (count > (1ULL << PHYS_BUDDY_MAX_ORDER))
+        return phys_alloc_frames_scan(count);
+
+    uint32_t order = buddy_order_for(count);
+    uint64_t start = buddy_take(order);
+    if (start == PHYS_BUDDY_NONE)
+        return 0; // OOM / fragmentasyon
+
+    for (uint64_t f = start; f < start + count; ++f)
+        frame_set(f);
+    g_free_frames -= count;
+
+    // 2^order - count kadar fazlalığı geri ver
+    buddy_insert_range(start + count, start + (1ULL << order));
+
+    return frame_idx_to_addr(start);
+}
+
 /**
  * Birden fazla ardışık frame ayırır.
  * Bu, sayfa tabloları (PML4/PDPT/PD/PT) oluştururken VE
  * DMA gibi contiguous memory gerektiğinde çok önemlidir.
  *
+ * count 2'nin kuvvetine yuvarlanıp buddy'den alınır; artan kuyruk
+ * frame'leri hemen buddy'ye geri verilir. 2^PHYS_BUDDY_MAX_ORDER'dan
+ * büyük (nadir) istekler için bitmap taramasına düşülür.
+ *
  * @param count Kaç frame isteniyor (ör: 4 frame → 16KB)
  */
 uint64_t phys_alloc_frames(uint64_t count)
 {
+    return phys_alloc_frames_at(count, MM_STATS_CALLER);
+}
+
+uint64_t phys_alloc_frames_at(uint64_t count, void *site)
+{
+    (void)site;
+
     if (count == 0)
         return 0;
 
     if (count == 1)
-        return phys_alloc_frame();
+        return phys_alloc_frame_at(site);
+
+    uint64_t flags = spin_lock_irqsave(&g_phys_lock);
+    uint64_t phys  = phys_alloc_frames_locked(count);
+    spin_unlock_irqrestore(&g_phys_lock, flags);
+
+    if (!phys) {
+        // Bu CPU'nun magazine'indeki frame'ler buddy'leri bölüyor olabilir:
+        // geri verip bir kez daha dene.
+        flags = cpu_irq_save();
+        phys_magazine_t *mag = &g_phys_mag[cpu_current_id()];
+        phys_mag_drain(mag, mag->count);
+
+        spin_lock(&g_phys_lock);
+        phys = phys_alloc_frames_locked(count);
+        spin_unlock(&g_phys_lock);
+        cpu_irq_restore(flags);
+    }
 
-    uint64_t chain_start = 0;
-    uint64_t chain_len   = 0;
+    if (phys)
+        MM_STATS_ALLOC_AT(MM_STAT_FRAME, site, count * AYKEN_FRAME_SIZE);
+    return phys;
+}
 
-    // Tüm frame bitmap’ini tara
-    for (uint64_t i = 0; i < AYKEN_MAX_FRAMES; ++i)
-    {
-        if (!frame_test(i)) {
-            // frame boş → zincir genişliyor
-            if (chain_len == 0)
-                chain_start = i;
 
-            chain_len++;
 
-            if (chain_len == count) {
-                uint64_t phys_start_addr = frame_idx_to_addr(chain_start);
+/**
+ * Birden fazla ardışık frame free et.
+ * Gerçekten kullanılan frame koşuları buddy'ye geri eklenir ve
+ * komşu boş bloklarla birleştirilir.
+ */
+void phys_free_frames(uint64_t phys_addr, uint64_t count)
+{
+    if (count == 0)
+        return;
 
-                // Tüm zinciri rezerve et
-                for (uint64_t f = chain_start; f < chain_start + count; f++) {
-                    frame_set(f);
-                    g_free_frames--;
-                }
+    MM_STATS_FREE(MM_STAT_FRAME, count * AYKEN_FRAME_SIZE);
+
+    uint64_t start_idx = addr_to_frame_idx(phys_addr);
+    uint64_t end_idx   = start_idx + count;
+    if (end_idx > g_max_frame)
+        end_idx = g_max_frame;
+
+    uint64_t flags = spin_lock_irqsave(&g_phys_lock);
+
+    // Yaygın durum: aralığın tamamı ayrılmış → word bazında tek geçiş
+    if (start_idx < end_idx &&
+        frame_range_count_used(start_idx, end_idx) == end_idx - start_idx) {
+        g_free_frames += frame_range_mark(start_idx, end_idx, 0);
+        buddy_insert_range(start_idx, end_idx);
+        spin_unlock_irqrestore(&g_phys_lock, flags);
+        return;
+    }
+
+    // Kısmen boş (double free) ya da delik içeren aralık: frame frame
+    uint64_t run_start = 0;
+    int      in_run    = 0;
+
+    for (uint64_t idx = start_idx; idx < end_idx; idx++) {
+        // Deliklerdeki frame'ler frame_test'te "used" görünür; atla
+        if (frame_section(idx) && frame_test(idx)) {
+            frame_clear(idx);
+            g_free_frames++;
 
-                g_last_alloc_search_idx = chain_start + count;
-                return phys_start_addr;
+            if (!in_run) {
+                run_start = idx;
+                in_run = 1;
             }
-        }
-        else {
-            // zincir bozuldu
-            chain_len = 0;
+        } else if (in_run) {
+            // zaten boş frame → koşu bitti (double free koruması)
+            buddy_insert_range(run_start, idx);
+            in_run = 0;
         }
     }
 
-    // Yer yok → OOM
-    return 0;
+    if (in_run)
+        buddy_insert_range(run_start, end_idx);
+
+    spin_unlock_irqrestore(&g_phys_lock, flags);
 }
 
 
 
+// ===========================================================================
+//  BOOT BELLEĞİ GERİ KAZANIMI (BootServices* / Loader*)
+// ===========================================================================
+
+// Reclaim sırasında hâlâ kullanımda olan bir frame'i geri "used" yap
+static void phys_reclaim_keep_frame(uint64_t phys, void *ctx)
+{
+    uint64_t *reclaimed = (uint64_t *)ctx;
+    uint64_t idx = addr_to_frame_idx(phys);
+
+    if (frame_section(idx) && !frame_test(idx)) {
+        frame_set(idx);
+        g_free_frames--;
+        g_total_frames--;
+        (*reclaimed)--;
+    }
+}
+
 /**
- * Birden fazla ardışık frame free et.
+ * Ayırmanın fiziksel üst sınırını değiştirir (paging, direct map
+ * kurulunca tüm RAM'e açar).
  */
-void phys_free_frames(uint64_t phys_addr, uint64_t count)
+void phys_mem_set_alloc_limit(uint64_t phys_end)
 {
-    if (count == 0)
-        return;
+    uint64_t flags = spin_lock_irqsave(&g_phys_lock);
+    g_alloc_limit = addr_to_frame_idx(phys_end);
+    spin_unlock_irqrestore(&g_phys_lock, flags);
+}
 
-    uint64_t start_idx = addr_to_frame_idx(phys_addr);
+/**
+ * phys_mem_init'te kaydedilen RAM aralıklarını [start, end) olarak gezer.
+ */
+void phys_mem_for_each_ram_range(void (*fn)(uint64_t start, uint64_t end, void *ctx),
+                                 void *ctx)
+{
+    for (uint32_t r = 0; r < g_ram_range_count; ++r)
+        fn(g_ram_ranges[r].start, g_ram_ranges[r].end, ctx);
+}
 
-    for (uint64_t i = 0; i < count; i++) {
-        uint64_t idx = start_idx + i;
-        if (idx >= AYKEN_MAX_FRAMES)
-            return;
+/**
+ * Frame henüz geri kazanılmamış bir boot bölgesinde mi?
+ * Bu frame'ler phys_free_frame'e verilmemeli: reclaim onları zaten
+ * (canlı değillerse) toplu olarak geri verir.
+ */
+int phys_mem_is_reclaimable(uint64_t phys_addr)
+{
+    uint64_t idx = addr_to_frame_idx(phys_addr);
 
-        if (frame_test(idx)) {
-            frame_clear(idx);
-            g_free_frames++;
+    for (uint32_t r = 0; r < g_reclaim_count; ++r) {
+        uint64_t first = g_reclaim_regions[r].first_frame;
+        if (idx >= first && idx < first + g_reclaim_regions[r].frame_count)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * phys_mem_init'te kaydedilen BootServicesCode/Data ve LoaderCode/Data
+ * bölgelerini allocator'a geri verir.
+ *
+ * Kernel hâlâ bootloader'ın page table'ları üzerinde çalıştığı için
+ * aktif PML4 hiyerarşisi korunur; aktif GDT'nin sayfaları da (gdt_init
+ * öncesinde UEFI'ninki) bırakılmaz. Boot stack'i üzerinde çağrılmamalıdır.
+ *
+ * @return geri kazanılan frame sayısı
+ */
+uint64_t phys_mem_reclaim_boot_memory(void)
+{
+    uint64_t pml4_phys = paging_get_kernel_pml4_phys();
+    if (!pml4_phys) {
+        fb_print("[phys_mem] reclaim skipped: kernel PML4 unknown.\n");
+        return 0;
+    }
+
+    uint64_t flags = spin_lock_irqsave(&g_phys_lock);
+    uint64_t reclaimed = 0;
+
+    // 1) Bölgeleri bitmap'te boşalt (buddy'ye henüz eklemeden);
+    //    ilk 1 MiB ve kernel imajı bölgeden kesilir
+    uint64_t low_end = addr_to_frame_idx(0x100000ULL);
+
+    for (uint32_t r = 0; r < g_reclaim_count; ++r) {
+        uint64_t first = g_reclaim_regions[r].first_frame;
+        uint64_t end   = first + g_reclaim_regions[r].frame_count;
+        uint64_t n     = 0;
+
+        if (first < low_end)
+            first = low_end;
+
+        if (first < g_kernel_first_frame)
+            n += frame_range_mark(first,
+                                  end < g_kernel_first_frame ? end : g_kernel_first_frame, 0);
+        if (end > g_kernel_last_frame + 1)
+            n += frame_range_mark(first > g_kernel_last_frame + 1 ? first : g_kernel_last_frame + 1,
+                                  end, 0);
+
+        g_free_frames  += n;
+        g_total_frames += n;
+        reclaimed      += n;
+    }
+
+    // 2) Canlı page table ve GDT frame'lerini geri al
+    paging_for_each_table_frame(pml4_phys, phys_reclaim_keep_frame, &reclaimed);
+
+    uint64_t gdt_base  = cpu_get_gdt_base();
+    uint64_t gdt_limit = cpu_get_gdt_limit();
+    for (uint64_t va = gdt_base & ~(AYKEN_FRAME_SIZE - 1);
+         va <= gdt_base + gdt_limit; va += AYKEN_FRAME_SIZE) {
+        uint64_t phys = paging_get_phys(va);
+        phys_reclaim_keep_frame(phys ? phys : va, &reclaimed);
+    }
 
-            if (idx < g_last_alloc_search_idx)
-                g_last_alloc_search_idx = idx;
+    // 3) Kalan boş koşuları buddy'ye ekle (komşularla birleşir)
+    for (uint32_t r = 0; r < g_reclaim_count; ++r) {
+        uint64_t first = g_reclaim_regions[r].first_frame;
+        uint64_t end   = first + g_reclaim_regions[r].frame_count;
+        uint64_t run_start = 0;
+        int      in_run    = 0;
+
+        for (uint64_t f = first; f < end; ++f) {
+            int freed = frame_section(f) && !frame_test(f) &&
+                        !buddy_covers(f);
+            if (freed) {
+                if (!in_run) {
+                    run_start = f;
+                    in_run = 1;
+                }
+            } else if (in_run) {
+                buddy_insert_range(run_start, f);
+                in_run = 0;
+            }
         }
+
+        if (in_run)
+            buddy_insert_range(run_start, end);
     }
+
+    g_reclaim_count = 0;
+
+    spin_unlock_irqrestore(&g_phys_lock, flags);
+
+    fb_print("[phys_mem] reclaimed boot memory: ");
+    fb_print_uint(reclaimed * AYKEN_FRAME_SIZE);
+    fb_print(" bytes\n");
+
+    return reclaimed;
 }
 
 
@@ -302,8 +1510,8 @@ void phys_free_frames(uint64_t phys_addr, uint64_t count)
 int phys_frame_is_used(uint64_t phys_addr)
 {
     uint64_t idx = addr_to_frame_idx(phys_addr);
-    if (idx >= AYKEN_MAX_FRAMES)
-        return -1; // geçersiz adres
+    if (!frame_section(idx))
+        return -1; // geçersiz adres / RAM deliği
 
     return frame_test(idx);
 }
@@ -315,4 +1523,12 @@ int phys_frame_is_used(uint64_t phys_addr)
 // ===========================================================================
 
 uint64_t phys_get_total_frames(void) { return g_total_frames; }
-uint64_t phys_get_free_frames(void)  { return g_free_frames; }
+
+uint64_t phys_get_free_frames(void)
+{
+    uint64_t cached = 0;
+    for (uint32_t c = 0; c < AYKEN_MAX_CPUS; ++c)
+        cached += g_phys_mag[c].count;
+
+    return g_free_frames + cached;
+}
@@ -0,0 +1,558 @@
+// kernel/mm/slab.c
+// ============================================================================
+//  AykenOS Slab Allocator (kmalloc küçük boyut sınıfları)
+//
+//  - 16..KSLAB_MAX_SIZE byte arası istekler sabit boyut sınıflarına
+//    yuvarlanır (2'nin kuvvetleri + arada ayarlı sınıflar: 48, 96, 192...).
+//  - Her sınıf KSLAB_SIZE (32 KB) boyutlu, KSLAB_SIZE hizalı slab'lardan
+//    object dağıtır. Slab başlığı slab'ın başında durur; kfree object
+//    adresini maskeleyerek başlığa O(1) ulaşır (object başına header yok).
+//  - Sınıf başına partial / full listeleri + tek yedek boş slab:
+//    alloc/free listelerde yürümeden O(1). Bu listeler sınıf kilidi
+//    altındaki paylaşılan "depot"tur.
+//  - Önünde per-CPU magazine'ler durur: kmalloc/kfree çoğunlukla yalnızca
+//    CPU'nun kendi stack'ine dokunur (kilit/atomik yok), depot'a toplu
+//    refill/flush ile gidilir.
+//  - Slab'lar KSLAB_START penceresinden 32 KB'lık chunk'lar halinde
+//    kesilir; chunk'ın sayfaları ilk kullanımda map edilir, slab tamamen
+//    boşalınca frame'ler allocator'a geri döner.
+//  - kmem_cache: aynı makine üzerinde tipli cache'ler (proc_t vb.).
+//    Object'ler cache line'a hizalanır, constructor yalnızca object slab'dan
+//    (depot) çıkarken çalışır; kullanıcı object'i inşa edilmiş halde geri
+//    verir ve object magazine'de sıcak bekler.
+// ============================================================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../include/ayken.h"
+#include "../include/mm.h"
+#include "../drivers/console/fb_console.h"
+#include "../arch/x86_64/cpu.h"
+#include "../arch/x86_64/spinlock.h"
+
+#define KSLAB_CHUNKS       (KSLAB_WINDOW_SIZE / KSLAB_SIZE)
+#define KSLAB_MAGIC        0x534C4142u   // "SLAB"
+#define KSLAB_GRANULE      16ULL
+
+// ---------------------------------------------------------------------------
+// Slab başlığı (slab'ın ilk byte'ları)
+//
+// Boş object'ler intrusive tek yönlü listede tutulur (object'in ilk
+// 8 byte'ı sonraki boş object). Hiç dağıtılmamış object'ler için liste
+// kurulmaz; "fresh" sayacı slab'ın sonuna doğru ilerler.
+// ---------------------------------------------------------------------------
+
+struct kslab_class;
+
+typedef struct kslab {
+    uint32_t            magic;
+    uint16_t            inuse;      // dağıtılmış object sayısı
+    uint16_t            fresh;      // hiç dağıtılmamış ilk object indeksi
+    struct kslab_class *cls;        // sahibi olan sınıf / cache
+    struct kslab       *next;
+    struct kslab       *prev;
+    void               *free;       // geri dönmüş object listesi
+} kslab_t;
+
+// Per-CPU object stack'i (sınıf başına). Büyük sınıflarda kapasite
+// düşürülür ki CPU başına tutulan bellek sınırlı kalsın.
+// allocs/frees yalnızca sahibi CPU tarafından yazılır (atomik gerekmez).
+#define KSLAB_MAG_MAX   32
+
+typedef struct {
+    uint32_t count;
+    void    *objs[KSLAB_MAG_MAX];
+    uint64_t allocs;
+    uint64_t frees;
+} __attribute__((aligned(64))) kslab_magazine_t;
+
+// kmalloc boyut sınıfı ya da tipli kmem_cache (mm.h: kmem_cache_t)
+typedef struct kslab_class {
+    const char *name;
+    uint32_t    size;          // object boyutu (hizalanmış)
+    uint32_t    per_slab;      // slab başına object
+    uint32_t    data_off;      // ilk object'in slab içi offset'i
+    uint32_t    mag_size;      // per-CPU magazine kapasitesi
+    uint32_t    mag_batch;     // refill/flush başına taşınan object
+    void      (*ctor)(void *obj);
+    spinlock_t  lock;
+    kslab_t    *partial;       // en az bir boş object'i olan slab'lar
+    kslab_t    *full;
+    kslab_t    *empty;         // yedek boş slab (alloc/free salınımında map/unmap'i önler)
+    uint64_t    slabs;
+    uint64_t    inuse;         // slab'lardan çıkmış object (magazine'dekiler dahil)
+    uint64_t    refills;       // depot'a giden refill/flush sayısı
+    uint64_t    flushes;
+    kslab_magazine_t mag[AYKEN_MAX_CPUS];
+} kslab_class_t;
+
+static const uint32_t g_kslab_sizes[] = {
+    16, 32, 48, 64, 96, 128, 192, 256,
+    384, 512, 768, 1024, 1536, 2048, 3072, 4096
+};
+
+#define KSLAB_CLASSES  (sizeof(g_kslab_sizes) / sizeof(g_kslab_sizes[0]))
+
+static kslab_class_t g_kslab_class[KSLAB_CLASSES];
+
+// Tipli cache'ler sabit havuzdan verilir (heap'e bağımlılık yok)
+#define KMEM_CACHE_MAX  16
+
+static kslab_class_t g_kmem_cache[KMEM_CACHE_MAX];
+static uint32_t      g_kmem_cache_count = 0;
+static spinlock_t    g_kmem_cache_lock  = SPINLOCK_INIT;
+
+// (size + 15) / 16 → sınıf indeksi; O(1) sınıf seçimi
+static uint8_t g_kslab_index[KSLAB_MAX_SIZE / KSLAB_GRANULE + 1];
+
+// Chunk yönetimi: bump pointer + geri dönen chunk'lar için stack
+static spinlock_t g_chunk_lock = SPINLOCK_INIT;
+static uint32_t   g_chunk_next = 0;
+static uint32_t   g_chunk_free[KSLAB_CHUNKS];
+static uint32_t   g_chunk_free_count = 0;
+
+static int g_kslab_ready = 0;
+
+
+// ============================================================================
+//  Chunk (32 KB sanal + fiziksel sayfalar)
+// ============================================================================
+
+static void kslab_chunk_put(uint64_t virt)
+{
+    uint64_t flags = spin_lock_irqsave(&g_chunk_lock);
+    g_chunk_free[g_chunk_free_count++] = (uint32_t)((virt - KSLAB_START) / KSLAB_SIZE);
+    spin_unlock_irqrestore(&g_chunk_lock, flags);
+}
+
+static void kslab_chunk_release(uint64_t virt)
+{
+    paging_unmap_range(virt, KSLAB_SIZE, 1);
+    kslab_chunk_put(virt);
+}
+
+static uint64_t kslab_chunk_alloc(void)
+{
+    uint64_t idx;
+
+    uint64_t flags = spin_lock_irqsave(&g_chunk_lock);
+    if (g_chunk_free_count) {
+        idx = g_chunk_free[--g_chunk_free_count];
+    } else if (g_chunk_next < KSLAB_CHUNKS) {
+        idx = g_chunk_next++;
+    } else {
+        spin_unlock_irqrestore(&g_chunk_lock, flags);
+        return 0;
+    }
+    spin_unlock_irqrestore(&g_chunk_lock, flags);
+
+    uint64_t virt = KSLAB_START + idx * KSLAB_SIZE;
+
+    // Tek tablo yürüyüşü; başarısızlıkta hiçbir sayfa map'li kalmaz
+    if (paging_map_anon(virt, KSLAB_SIZE, 0) != 0) {
+        kslab_chunk_put(virt);
+        return 0;
+    }
+
+    return virt;
+}
+
+
+// ============================================================================
+//  Liste yardımcıları (çift yönlü, O(1) çıkarma)
+// ============================================================================
+
+static inline void kslab_list_push(kslab_t **head, kslab_t *sl)
+{
+    sl->prev = NULL;
+    sl->next = *head;
+    if (*head)
+        (*head)->prev = sl;
+    *head = sl;
+}
+
+static inline void kslab_list_remove(kslab_t **head, kslab_t *sl)
+{
+    if (sl->prev)
+        sl->prev->next = sl->next;
+    else
+        *head = sl->next;
+    if (sl->next)
+        sl->next->prev = sl->prev;
+    sl->next = sl->prev = NULL;
+}
+
+
+// ============================================================================
+//  kslab_init
+// ============================================================================
+
+// İlk object cache line hizalı başlar
+#define KSLAB_DATA_OFF   ((uint32_t)((sizeof(kslab_t) + 63) & ~63ULL))
+
+static void kslab_class_setup(kslab_class_t *cls, const char *name,
+                              uint32_t size, void (*ctor)(void *obj))
+{
+    cls->name     = name;
+    cls->size     = size;
+    cls->ctor     = ctor;
+    cls->data_off = KSLAB_DATA_OFF;
+    cls->per_slab = (uint32_t)((KSLAB_SIZE - cls->data_off) / size);
+    spin_lock_init(&cls->lock);
+    cls->partial = cls->full = cls->empty = NULL;
+    cls->slabs   = 0;
+    cls->inuse   = 0;
+    cls->refills = 0;
+    cls->flushes = 0;
+
+    // ≤256 B: 32, ≤1 KB: 16, daha büyük: 8 object
+    cls->mag_size  = size <= 256 ? KSLAB_MAG_MAX :
+                     size <= 1024 ? KSLAB_MAG_MAX / 2 : KSLAB_MAG_MAX / 4;
+    cls->mag_batch = cls->mag_size / 2;
+
+    for (uint32_t cpu = 0; cpu < AYKEN_MAX_CPUS; ++cpu) {
+        cls->mag[cpu].count  = 0;
+        cls->mag[cpu].allocs = 0;
+        cls->mag[cpu].frees  = 0;
+    }
+}
+
+void kslab_init(void)
+{
+    uint32_t c = 0;
+    for (uint64_t i = 0; i <= KSLAB_MAX_SIZE / KSLAB_GRANULE; ++i) {
+        while (g_kslab_sizes[c] < i * KSLAB_GRANULE)
+            c++;
+        g_kslab_index[i] = (uint8_t)c;
+    }
+
+    for (uint32_t i = 0; i < KSLAB_CLASSES; ++i)
+        kslab_class_setup(&g_kslab_class[i], "kmalloc", g_kslab_sizes[i], NULL);
+
+    g_kmem_cache_count = 0;
+    g_chunk_next = 0;
+    g_chunk_free_count = 0;
+    g_kslab_ready = 1;
+
+    fb_print("[slab] size classes ready (16..4096 bytes, 32KB slabs).\n");
+}
+
+
+// ============================================================================
+//  Depot (sınıf kilidi altında slab listeleri)
+//  *_locked fonksiyonları cls->lock tutulurken çağrılır.
+// ============================================================================
+
+static kslab_t *kslab_new(kslab_class_t *cls)
+{
+    uint64_t virt = kslab_chunk_alloc();
+    if (!virt)
+        return NULL;
+
+    kslab_t *sl = (kslab_t *)virt;
+    sl->magic = KSLAB_MAGIC;
+    sl->cls   = cls;
+    sl->inuse = 0;
+    sl->fresh = 0;
+    sl->free  = NULL;
+    sl->next  = sl->prev = NULL;
+
+    cls->slabs++;
+    return sl;
+}
+
+static void *kslab_alloc_locked(kslab_class_t *cls)
+{
+    kslab_t *sl = cls->partial;
+    if (!sl) {
+        sl = cls->empty;
+        if (sl)
+            cls->empty = NULL;
+        else
+            sl = kslab_new(cls);
+
+        if (!sl)
+            return NULL;
+        kslab_list_push(&cls->partial, sl);
+    }
+
+    void *obj;
+    if (sl->free) {
+        obj = sl->free;
+        sl->free = *(void **)obj;
+    } else {
+        obj = (uint8_t *)sl + cls->data_off + (uint64_t)sl->fresh * cls->size;
+        sl->fresh++;
+    }
+
+    // Slab free list'i object'in ilk word'ünü link olarak kullanır; bu yüzden
+    // constructor object depot'tan her çıkışta çalışır. Magazine'den dönen
+    // sıcak object'ler inşa edilmiş halde kalır.
+    if (cls->ctor)
+        cls->ctor(obj);
+
+    sl->inuse++;
+    cls->inuse++;
+
+    if (sl->inuse == cls->per_slab) {
+        kslab_list_remove(&cls->partial, sl);
+        kslab_list_push(&cls->full, sl);
+    }
+
+    return obj;
+}
+
+// Object'i slab'ına geri koy. Slab tamamen boşaldıysa ve yedek zaten
+// varsa slab *release listesine eklenir; sayfaları kilit dışında geri verilir.
+static void kslab_free_locked(kslab_class_t *cls, kslab_t *sl, void *ptr,
+                              kslab_t **release)
+{
+    if (sl->inuse == cls->per_slab) {
+        kslab_list_remove(&cls->full, sl);
+        kslab_list_push(&cls->partial, sl);
+    }
+
+    *(void **)ptr = sl->free;
+    sl->free = ptr;
+    sl->inuse--;
+    cls->inuse--;
+
+    if (sl->inuse == 0) {
+        kslab_list_remove(&cls->partial, sl);
+        if (!cls->empty) {
+            cls->empty = sl;
+        } else {
+            sl->magic = 0;
+            cls->slabs--;
+            sl->next = *release;
+            *release = sl;
+        }
+    }
+}
+
+static void kslab_release_list(kslab_t *release)
+{
+    while (release) {
+        kslab_t *next = release->next;
+        kslab_chunk_release((uint64_t)release);
+        release = next;
+    }
+}
+
+
+// ============================================================================
+//  Per-CPU magazine'ler
+//
+//  Her CPU'nun her sınıf için küçük bir object stack'i vardır. Fast path
+//  yalnızca kesmeleri kapatır (aynı CPU'da reentrancy); atomik işlem ve
+//  paylaşılan cache line yoktur. Magazine boşalınca/dolunca depot'a
+//  (sınıf kilidi) tek seferde mag_batch object taşınır.
+// ============================================================================
+
+static void kslab_mag_refill(kslab_class_t *cls, kslab_magazine_t *mag)
+{
+    uint64_t flags = spin_lock_irqsave(&cls->lock);
+
+    while (mag->count < cls->mag_batch) {
+        void *obj = kslab_alloc_locked(cls);
+        if (!obj)
+            break;
+        mag->objs[mag->count++] = obj;
+    }
+    cls->refills++;
+
+    spin_unlock_irqrestore(&cls->lock, flags);
+}
+
+static void kslab_mag_flush(kslab_class_t *cls, kslab_magazine_t *mag, uint32_t n)
+{
+    kslab_t *release = NULL;
+
+    uint64_t flags = spin_lock_irqsave(&cls->lock);
+
+    while (n-- && mag->count) {
+        void *obj = mag->objs[--mag->count];
+        kslab_t *sl = (kslab_t *)((uint64_t)obj & ~(KSLAB_SIZE - 1));
+        kslab_free_locked(cls, sl, obj, &release);
+    }
+    cls->flushes++;
+
+    spin_unlock_irqrestore(&cls->lock, flags);
+
+    kslab_release_list(release);
+}
+
+// Fast path: yalnızca bu CPU'nun magazine'i
+static void *kslab_class_alloc(kslab_class_t *cls)
+{
+    uint64_t flags = cpu_irq_save();
+    kslab_magazine_t *mag = &cls->mag[cpu_current_id()];
+
+    if (mag->count == 0)
+        kslab_mag_refill(cls, mag);
+
+    void *obj = NULL;
+    if (mag->count) {
+        obj = mag->objs[--mag->count];
+        mag->allocs++;
+    }
+
+    cpu_irq_restore(flags);
+    return obj;
+}
+
+static void kslab_class_free(kslab_class_t *cls, void *ptr)
+{
+    uint64_t flags = cpu_irq_save();
+    kslab_magazine_t *mag = &cls->mag[cpu_current_id()];
+
+    if (mag->count == cls->mag_size)
+        kslab_mag_flush(cls, mag, cls->mag_batch);
+
+    mag->objs[mag->count++] = ptr;
+    mag->frees++;
+
+    cpu_irq_restore(flags);
+}
+
+// Pointer'ın slab başlığı; geçersizse NULL
+static inline kslab_t *kslab_of(const void *ptr)
+{
+    kslab_t *sl = (kslab_t *)((uint64_t)ptr & ~(KSLAB_SIZE - 1));
+    return sl->magic == KSLAB_MAGIC ? sl : NULL;
+}
+
+
+// ============================================================================
+//  kslab_alloc / kslab_free (kmalloc boyut sınıfları)
+// ============================================================================
+
+void *kslab_alloc(uint64_t size)
+{
+    if (!g_kslab_ready || size == 0 || size > KSLAB_MAX_SIZE)
+        return NULL;
+
+    uint32_t idx = g_kslab_index[(size + KSLAB_GRANULE - 1) / KSLAB_GRANULE];
+
+    void *obj = kslab_class_alloc(&g_kslab_class[idx]);
+    if (!obj)
+        fb_print("[slab] WARNING: out of slab memory.\n");
+    return obj;
+}
+
+int kslab_owns(const void *ptr)
+{
+    uint64_t addr = (uint64_t)ptr;
+    return addr >= KSLAB_START && addr < KSLAB_START + KSLAB_WINDOW_SIZE;
+}
+
+uint64_t kslab_obj_size(const void *ptr)
+{
+    kslab_t *sl = kslab_of(ptr);
+    return sl ? sl->cls->size : 0;
+}
+
+// kmem_cache object'leri de buraya düşebilir: sahibi slab başlığından bulunur
+void kslab_free(void *ptr)
+{
+    if (!ptr)
+        return;
+
+    kslab_t *sl = kslab_of(ptr);
+    if (!sl) {
+        fb_print("[slab] ERROR: kfree on non-slab pointer.\n");
+        return;
+    }
+
+    kslab_class_free(sl->cls, ptr);
+}
+
+
+// ============================================================================
+//  kmem_cache (tipli object cache'leri)
+// ============================================================================
+
+kmem_cache_t *kmem_cache_create(const char *name, uint64_t size,
+                                uint64_t align, void (*ctor)(void *obj))
+{
+    if (!g_kslab_ready || size == 0)
+        return NULL;
+
+    // Varsayılan: cache line hizası (false sharing yok)
+    if (align < 64)
+        align = 64;
+    if (align & (align - 1))
+        return NULL;
+
+    uint64_t obj_size = (size + align - 1) & ~(align - 1);
+    if (obj_size > KSLAB_MAX_SIZE) {
+        fb_print("[slab] ERROR: kmem_cache object too large.\n");
+        return NULL;
+    }
+
+    uint64_t flags = spin_lock_irqsave(&g_kmem_cache_lock);
+    if (g_kmem_cache_count == KMEM_CACHE_MAX) {
+        spin_unlock_irqrestore(&g_kmem_cache_lock, flags);
+        fb_print("[slab] ERROR: kmem_cache table full.\n");
+        return NULL;
+    }
+    kslab_class_t *cls = &g_kmem_cache[g_kmem_cache_count++];
+    spin_unlock_irqrestore(&g_kmem_cache_lock, flags);
+
+    kslab_class_setup(cls, name, (uint32_t)obj_size, ctor);
+
+    // data_off 64 hizalı; daha büyük hizalar için ilk object'i kaydır
+    cls->data_off = (uint32_t)((KSLAB_DATA_OFF + align - 1) & ~(align - 1));
+    cls->per_slab = (uint32_t)((KSLAB_SIZE - cls->data_off) / obj_size);
+
+    return cls;
+}
+
+void *kmem_cache_alloc(kmem_cache_t *cache)
+{
+    if (!cache)
+        return NULL;
+    return kslab_class_alloc(cache);
+}
+
+void kmem_cache_free(kmem_cache_t *cache, void *obj)
+{
+    if (!cache || !obj)
+        return;
+
+    kslab_t *sl = kslab_of(obj);
+    if (!sl || sl->cls != cache) {
+        fb_print("[slab] ERROR: kmem_cache_free with wrong cache.\n");
+        return;
+    }
+
+    kslab_class_free(cache, obj);
+}
+
+void kmem_cache_get_stats(kmem_cache_t *cache, kmem_cache_stats_t *out)
+{
+    if (!cache || !out)
+        return;
+
+    out->name     = cache->name;
+    out->obj_size = cache->size;
+    out->per_slab = cache->per_slab;
+
+    uint64_t flags = spin_lock_irqsave(&cache->lock);
+    out->slabs   = cache->slabs;
+    out->refills = cache->refills;
+    out->flushes = cache->flushes;
+
+    // Slab'dan çıkmış ama magazine'de bekleyenler kullanımda sayılmaz
+    uint64_t cached = 0, allocs = 0, frees = 0;
+    for (uint32_t cpu = 0; cpu < AYKEN_MAX_CPUS; ++cpu) {
+        cached += cache->mag[cpu].count;
+        allocs += cache->mag[cpu].allocs;
+        frees  += cache->mag[cpu].frees;
+    }
+    out->active  = cache->inuse - cached;
+    out->cached  = cached;
+    out->allocs  = allocs;
+    out->frees   = frees;
+    spin_unlock_irqrestore(&cache->lock, flags);
+}
@@ -0,0 +1,486 @@
+// kernel/mm/vm.c
+// ============================================================================
+//  AykenOS User Adres Alanı (demand paging)
+//
+//  - Her user process'in sanal belleği bölge tanımlarıyla (vm_region_t)
+//    anlatılır; loader sayfa ayırmaz, yalnızca bölge kaydeder.
+//  - Sayfalar ilk dokunuşta #PF içinde oluşur:
+//      ANON  → sıfır sayfa
+//      FILE  → imaj baytlarından kopya (src_len'den sonrası sıfır)
+//      STACK → sıfır sayfa; bölge limit'e kadar aşağı doğru büyür
+//  - İçeriği tamamen sıfır olan sayfaya (ANON/STACK, FILE'da BSS) ilk
+//    dokunuş okumaysa frame ayrılmaz: paylaşılan salt okunur sıfır frame'i
+//    COW olarak map edilir, ilk yazmada paging_cow_break özel kopya verir.
+//  - FILE kaynağı (initrd imajı ya da statik dizi) process ömrü boyunca
+//    bellekte kalmalıdır; bayt kopyalanmaz, yalnızca işaret edilir.
+//  - vm_space_clone: bölgeler kopyalanır, oluşmuş sayfalar copy-on-write
+//    paylaşılır (paging_cow_share); yazma #PF'i paging_cow_break'e gider.
+//    STACK bölgesi istisna: çalışan stack her iki tarafta hemen yazılır
+//    (interrupt frame'leri dahil), sayfaları baştan kopyalanır.
+//  - Bölgeler sayfa hizalıdır ve çakışmaz; start'a göre sıralı bir
+//    pointer dizisinde tutulur: arama ikili (O(log n)), ekleme/silme
+//    dizide kaydırma. Dizi kmalloc'tan, dolunca iki katına büyür.
+//  - vm_mmap/vm_munmap: USER_MMAP_BASE..USER_MMAP_END arasında anonim
+//    bölgeler; sayfalar yine ilk dokunuşta sıfırla doldurulur.
+//  - Kilit yok: #PF interrupt gate'i kesmeleri kapalı tutar ve bölge
+//    dizisi yalnızca sahibi process bağlamından değişir (tek CPU).
+// ============================================================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "../include/ayken.h"
+#include "../include/mm.h"
+#include "../include/proc.h"
+#include "../sched/sched.h"
+#include "../drivers/console/fb_console.h"
+
+// Stack, en alttaki bölge sayfasının en fazla bu kadar altına dokunursa büyür
+#define VM_STACK_GAP        (16 * AYKEN_FRAME_SIZE)
+
+// Bölge dizisinin ilk kapasitesi
+#define VM_REGIONS_INITIAL  8
+
+// #PF hata kodu bitleri
+#define PF_PRESENT          (1ULL << 0)
+#define PF_WRITE            (1ULL << 1)
+
+static kmem_cache_t *g_vm_space_cache  = NULL;
+static kmem_cache_t *g_vm_region_cache = NULL;
+
+// Tüm adres alanlarının paylaştığı sıfır frame'i (0 → kullanılmıyor).
+// Kalıcı ve sahipsiz (paging_zero_frame): map'ler referans almaz.
+static uint64_t      g_vm_zero_frame   = 0;
+
+static inline uint64_t vm_page_down(uint64_t x)
+{
+    return x & ~(AYKEN_FRAME_SIZE - 1);
+}
+
+static inline uint64_t vm_page_up(uint64_t x)
+{
+    return (x + AYKEN_FRAME_SIZE - 1) & ~(AYKEN_FRAME_SIZE - 1);
+}
+
+// Bölgenin işgal ettiği en alt adres (stack için büyüme sınırı dahil)
+static inline uint64_t vm_region_floor(const vm_region_t *r)
+{
+    return r->kind == VM_REGION_STACK ? r->limit : r->start;
+}
+
+void vm_init(void)
+{
+    if (!g_vm_space_cache)
+        g_vm_space_cache = kmem_cache_create("vm_space", sizeof(vm_space_t), 0, NULL);
+    if (!g_vm_region_cache)
+        g_vm_region_cache = kmem_cache_create("vm_region", sizeof(vm_region_t), 0, NULL);
+    if (!g_vm_zero_frame)
+        g_vm_zero_frame = paging_zero_frame();
+}
+
+vm_space_t *vm_space_create(uint64_t pml4_phys)
+{
+    vm_space_t *vm = (vm_space_t *)kmem_cache_alloc(g_vm_space_cache);
+    if (!vm)
+        return NULL;
+
+    vm->pml4_phys = pml4_phys;
+    vm->regions   = NULL;
+    vm->count     = 0;
+    vm->cap       = 0;
+    vm->resident  = 0;
+    return vm;
+}
+
+void vm_space_destroy(vm_space_t *vm)
+{
+    if (!vm)
+        return;
+
+    for (uint32_t i = 0; i < vm->count; ++i) {
+        vm_region_t *r = vm->regions[i];
+        paging_unmap_range_in_pml4(vm->pml4_phys, r->start, r->end - r->start, 1);
+        kmem_cache_free(g_vm_region_cache, r);
+    }
+
+    kfree(vm->regions);
+    kmem_cache_free(g_vm_space_cache, vm);
+}
+
+static int vm_regions_reserve(vm_space_t *vm, uint32_t need)
+{
+    if (need <= vm->cap)
+        return 0;
+
+    uint32_t cap = vm->cap ? vm->cap * 2 : VM_REGIONS_INITIAL;
+    while (cap < need)
+        cap *= 2;
+
+    vm_region_t **arr = (vm_region_t **)kmalloc(cap * sizeof(vm_region_t *));
+    if (!arr)
+        return -1;
+
+    if (vm->count)
+        memcpy(arr, vm->regions, vm->count * sizeof(vm_region_t *));
+    kfree(vm->regions);
+
+    vm->regions = arr;
+    vm->cap     = cap;
+    return 0;
+}
+
+vm_space_t *vm_space_clone(vm_space_t *src, uint64_t dst_pml4_phys)
+{
+    vm_space_t *vm = vm_space_create(dst_pml4_phys);
+    if (!vm)
+        return NULL;
+
+    if (vm_regions_reserve(vm, src->count) != 0)
+        goto fail;
+
+    for (uint32_t i = 0; i < src->count; ++i) {
+        vm_region_t *r = src->regions[i];
+        vm_region_t *c = (vm_region_t *)kmem_cache_alloc(g_vm_region_cache);
+        if (!c)
+            goto fail;
+
+        *c = *r;
+        vm->regions[vm->count++] = c;
+
+        // Yarıda kalırsa src'de COW işaretli kalan sayfalar zararsız:
+        // tek sahipleri kalınca ilk yazmada izin geri verilir.
+        int rc = (r->kind == VM_REGION_STACK)
+                     ? paging_copy_range(src->pml4_phys, dst_pml4_phys,
+                                         r->start, r->end - r->start)
+                     : paging_cow_share(src->pml4_phys, dst_pml4_phys,
+                                        r->start, r->end - r->start);
+        if (rc != 0)
+            goto fail;
+    }
+
+    vm->resident = src->resident;
+    return vm;
+
+fail:
+    vm_space_destroy(vm);
+    return NULL;
+}
+
+// addr'den sonra biten ilk bölgenin indeksi (yoksa count).
+// Bölgeler çakışmadığı için end'ler de sıralı.
+static uint32_t vm_region_lower_bound(const vm_space_t *vm, uint64_t addr)
+{
+    uint32_t lo = 0, hi = vm->count;
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (vm->regions[mid]->end <= addr)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// [start, end) hiçbir bölgenin (stack büyüme alanı dahil) üstüne düşmüyor mu?
+static int vm_range_free(const vm_space_t *vm, uint64_t start, uint64_t end)
+{
+    uint32_t i = vm_region_lower_bound(vm, start);
+    return i == vm->count || vm_region_floor(vm->regions[i]) >= end;
+}
+
+static void vm_region_remove_at(vm_space_t *vm, uint32_t i)
+{
+    memmove(&vm->regions[i], &vm->regions[i + 1],
+            (vm->count - i - 1) * sizeof(vm_region_t *));
+    vm->count--;
+}
+
+// Çakışma yoksa sıralı diziye ekler
+static int vm_region_insert(vm_space_t *vm, vm_region_t *nr)
+{
+    if (!vm_range_free(vm, vm_region_floor(nr), nr->end))
+        return -1;
+    if (vm_regions_reserve(vm, vm->count + 1) != 0)
+        return -1;
+
+    uint32_t i = vm_region_lower_bound(vm, vm_region_floor(nr));
+    memmove(&vm->regions[i + 1], &vm->regions[i],
+            (vm->count - i) * sizeof(vm_region_t *));
+    vm->regions[i] = nr;
+    vm->count++;
+    return 0;
+}
+
+static vm_region_t *vm_region_new(vm_space_t *vm, vm_region_kind_t kind,
+                                  uint64_t start, uint64_t size, uint64_t flags)
+{
+    if (!vm || size == 0 || (start & (AYKEN_FRAME_SIZE - 1)))
+        return NULL;
+
+    vm_region_t *r = (vm_region_t *)kmem_cache_alloc(g_vm_region_cache);
+    if (!r)
+        return NULL;
+
+    r->start   = start;
+    r->end     = start + vm_page_up(size);
+    r->flags   = flags | AYKEN_PTE_USER;
+    r->kind    = kind;
+    r->src     = NULL;
+    r->src_len = 0;
+    r->limit   = start;
+    return r;
+}
+
+static int vm_region_commit(vm_space_t *vm, vm_region_t *r)
+{
+    if (vm_region_insert(vm, r) != 0) {
+        fb_print("[vm] ERROR: cannot insert region at ");
+        fb_print_hex(r->start);
+        fb_print("\n");
+        kmem_cache_free(g_vm_region_cache, r);
+        return -1;
+    }
+    return 0;
+}
+
+int vm_map_anon(vm_space_t *vm, uint64_t start, uint64_t size, uint64_t flags)
+{
+    vm_region_t *r = vm_region_new(vm, VM_REGION_ANON, start, size, flags);
+    if (!r)
+        return -1;
+    return vm_region_commit(vm, r);
+}
+
+int vm_map_file(vm_space_t *vm, uint64_t start, uint64_t size, uint64_t flags,
+                const uint8_t *src, uint64_t src_len)
+{
+    vm_region_t *r = vm_region_new(vm, VM_REGION_FILE, start, size, flags);
+    if (!r)
+        return -1;
+
+    r->src     = src;
+    r->src_len = src_len < r->end - start ? src_len : r->end - start;
+    return vm_region_commit(vm, r);
+}
+
+int vm_map_stack(vm_space_t *vm, uint64_t top, uint64_t size, uint64_t max_size,
+                 uint64_t flags)
+{
+    size = vm_page_up(size);
+    if (size > max_size || top < max_size)
+        return -1;
+
+    vm_region_t *r = vm_region_new(vm, VM_REGION_STACK, top - size, size, flags);
+    if (!r)
+        return -1;
+
+    r->limit = top - vm_page_up(max_size);
+    return vm_region_commit(vm, r);
+}
+
+vm_region_t *vm_region_find(vm_space_t *vm, uint64_t addr)
+{
+    if (!vm)
+        return NULL;
+
+    uint32_t i = vm_region_lower_bound(vm, addr);
+    if (i == vm->count || addr < vm_region_floor(vm->regions[i]))
+        return NULL;
+    return vm->regions[i];
+}
+
+
+// ============================================================================
+//  vm_mmap / vm_munmap
+// ============================================================================
+
+uint64_t vm_mmap(vm_space_t *vm, uint64_t addr, uint64_t size, uint64_t flags)
+{
+    if (!vm || size == 0 || size > USER_MMAP_END - USER_MMAP_BASE)
+        return 0;
+
+    size = vm_page_up(size);
+
+    // İpucu: tam o adres boşsa kullanılır, değilse ilk uygun boşluk
+    uint64_t start = 0;
+    if (addr && !(addr & (AYKEN_FRAME_SIZE - 1)) &&
+        addr >= USER_MMAP_BASE && addr <= USER_MMAP_END - size &&
+        vm_range_free(vm, addr, addr + size)) {
+        start = addr;
+    } else {
+        uint64_t cand = USER_MMAP_BASE;
+        for (uint32_t i = vm_region_lower_bound(vm, cand); i < vm->count; ++i) {
+            vm_region_t *r = vm->regions[i];
+            if (vm_region_floor(r) >= cand + size)
+                break;
+            cand = r->end;
+        }
+        if (cand <= USER_MMAP_END - size)
+            start = cand;
+    }
+
+    if (!start || vm_map_anon(vm, start, size, flags) != 0)
+        return 0;
+    return start;
+}
+
+// FILE bölgesinin başını new_start'a çeker (kaynak ofseti kayar)
+static void vm_region_trim_front(vm_region_t *r, uint64_t new_start)
+{
+    uint64_t off = new_start - r->start;
+
+    if (r->kind == VM_REGION_FILE) {
+        if (r->src_len > off) {
+            r->src     += off;
+            r->src_len -= off;
+        } else {
+            r->src     = NULL;
+            r->src_len = 0;
+        }
+    }
+    r->start = new_start;
+    r->limit = new_start;
+}
+
+static void vm_region_trim_back(vm_region_t *r, uint64_t new_end)
+{
+    r->end = new_end;
+    if (r->src_len > new_end - r->start)
+        r->src_len = new_end - r->start;
+}
+
+int vm_munmap(vm_space_t *vm, uint64_t addr, uint64_t size)
+{
+    if (!vm || size == 0 || (addr & (AYKEN_FRAME_SIZE - 1)) ||
+        addr >= USER_SPACE_END || size > USER_SPACE_END - addr)
+        return -1;
+
+    uint64_t end = addr + vm_page_up(size);
+    uint32_t first = vm_region_lower_bound(vm, addr);
+
+    // Önce doğrula: stack kısmen sökülmez, ortadan bölme yeni bölge ister
+    vm_region_t *spare = NULL;
+    for (uint32_t i = first; i < vm->count && vm->regions[i]->start < end; ++i) {
+        vm_region_t *r = vm->regions[i];
+        if (r->kind == VM_REGION_STACK)
+            return -1;
+        if (r->start < addr && r->end > end) {
+            spare = (vm_region_t *)kmem_cache_alloc(g_vm_region_cache);
+            if (!spare || vm_regions_reserve(vm, vm->count + 1) != 0) {
+                if (spare)
+                    kmem_cache_free(g_vm_region_cache, spare);
+                return -1;
+            }
+        }
+    }
+
+    uint32_t i = first;
+    while (i < vm->count && vm->regions[i]->start < end) {
+        vm_region_t *r = vm->regions[i];
+
+        if (r->start >= addr && r->end <= end) {
+            vm_region_remove_at(vm, i);
+            kmem_cache_free(g_vm_region_cache, r);
+            continue;
+        }
+
+        if (r->start < addr && r->end > end) {
+            // Ortadan bölme: üst parça yeni bölge
+            *spare = *r;
+            vm_region_trim_front(spare, end);
+            vm_region_trim_back(r, addr);
+            memmove(&vm->regions[i + 2], &vm->regions[i + 1],
+                    (vm->count - i - 1) * sizeof(vm_region_t *));
+            vm->regions[i + 1] = spare;
+            vm->count++;
+            break;
+        }
+
+        if (r->start < addr)
+            vm_region_trim_back(r, addr);
+        else
+            vm_region_trim_front(r, end);
+        ++i;
+    }
+
+    uint64_t pages = paging_unmap_range_in_pml4(vm->pml4_phys, addr, end - addr, 1);
+    vm->resident -= pages < vm->resident ? pages : vm->resident;
+    return 0;
+}
+
+// FILE sayfası: sıfır frame'in üstüne kaynak baytlar
+static void vm_fill_page(const vm_region_t *r, uint64_t page, uint8_t *dst)
+{
+    uint64_t off = page - r->start;
+    if (off >= r->src_len)
+        return;
+
+    uint64_t n = r->src_len - off;
+    memcpy(dst, r->src + off, n < AYKEN_FRAME_SIZE ? n : AYKEN_FRAME_SIZE);
+}
+
+int vm_handle_fault(vm_space_t *vm, uint64_t addr, uint64_t err)
+{
+    vm_region_t *r = vm_region_find(vm, addr);
+    if (!r)
+        return -1;
+
+    if ((err & PF_WRITE) && !(r->flags & AYKEN_PTE_WRITABLE))
+        return -1;
+
+    // Map'li sayfa: yalnızca COW paylaşımına yazma çözülebilir
+    if (err & PF_PRESENT)
+        return (err & PF_WRITE) ? paging_cow_break(vm->pml4_phys, addr) : -1;
+
+    uint64_t page = vm_page_down(addr);
+
+    if (page < r->start) {
+        // Stack büyümesi: yalnızca mevcut tabana yakın dokunuşlar
+        if (r->start - page > VM_STACK_GAP)
+            return -1;
+        r->start = page;
+    }
+
+    // Yalnızca okunan sıfır sayfası: ortak frame, bellek harcanmaz
+    if (!(err & PF_WRITE) && g_vm_zero_frame &&
+        (r->kind != VM_REGION_FILE || page - r->start >= r->src_len)) {
+        if (paging_map_cow_in_pml4(vm->pml4_phys, page, g_vm_zero_frame, r->flags) != 0)
+            return -1;
+        vm->resident++;
+        return 0;
+    }
+
+    uint64_t phys = phys_alloc_zeroed_frame();
+    if (!phys)
+        return -1;
+
+    if (r->kind == VM_REGION_FILE)
+        vm_fill_page(r, page, (uint8_t *)paging_phys_to_virt(phys));
+
+    // Fault eden adres alanı zaten yüklü; boş giriş TLB'de olamaz
+    if (paging_map_range_in_pml4(vm->pml4_phys, page, &phys, 1, r->flags) != 0) {
+        phys_free_frame(phys);
+        return -1;
+    }
+
+    vm->resident++;
+    return 0;
+}
+
+int vm_prefault(vm_space_t *vm, uint64_t start, uint64_t size)
+{
+    for (uint64_t va = vm_page_down(start); va < start + size; va += AYKEN_FRAME_SIZE) {
+        if (vm_handle_fault(vm, va, PF_WRITE) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+int vm_page_fault(uint64_t addr, uint64_t err)
+{
+    if (addr >= USER_SPACE_END || !current_proc || !current_proc->vm)
+        return -1;
+
+    return vm_handle_fault(current_proc->vm, addr, err);
+}
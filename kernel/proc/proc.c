@@ -1,13 +1,18 @@
 // kernel/proc/proc.c
 #include <string.h>
 #include "../include/proc.h"
-#include "../include/sched.h"
+#include "../sched/sched.h"
 #include "../include/mm.h"
 #include "../include/ayken.h"
 #include "../drivers/console/fb_console.h"
+#include "../arch/x86_64/cpu.h"
 
 static int next_pid = 1;
 
+// proc_t'ler ayrı cache'ten: cache line hizalı; ctor yok, proc_alloc
+// object'i bir kez sıfırlar
+static kmem_cache_t *g_proc_cache = NULL;
+
 void init_process_main(void);
 
 static int proc_alloc_pid(void)
@@ -45,7 +50,7 @@ typedef struct {
 
 static proc_t *proc_alloc(proc_type_t type, const char *name)
 {
-    proc_t *p = (proc_t *)kmalloc(sizeof(proc_t));
+    proc_t *p = (proc_t *)kmem_cache_alloc(g_proc_cache);
     if (!p) return NULL;
 
     memset(p, 0, sizeof(proc_t));
@@ -59,25 +64,37 @@ static proc_t *proc_alloc(proc_type_t type, const char *name)
     return p;
 }
 
-static uint64_t load_flat_image(uint64_t pml4_phys, const uint8_t *image, uint64_t size)
+// Process'in sahip olduğu her şeyi geri verir: kernel stack'i (yalnızca
+// kernel thread'lerde kstack_alloc'tan gelir), user bölgeleri, PML4, proc_t.
+static void proc_free(proc_t *p)
 {
-    uint64_t phys = phys_alloc_frame();
-    if (!phys)
-        return 0;
+    if (p->type == PROC_TYPE_KERNEL && p->stack_top)
+        kstack_free(p->stack_top);
+
+    if (p->vm)
+        vm_space_destroy(p->vm);
 
-    uint8_t *dst = (uint8_t *)paging_phys_to_virt(phys);
-    memset(dst, 0, AYKEN_FRAME_SIZE);
+    if (p->pml4_phys != paging_get_kernel_pml4_phys())
+        paging_destroy_user_pml4(p->pml4_phys);
 
-    uint64_t copy = size < AYKEN_FRAME_SIZE ? size : AYKEN_FRAME_SIZE;
-    if (image && copy)
-        memcpy(dst, image, copy);
+    kmem_cache_free(g_proc_cache, p);
+}
+
+// İmaj baytları bölgelere yalnızca kaydedilir; sayfalar ilk dokunuşta
+// vm_handle_fault içinde oluşur. image process ömrü boyunca yaşamalıdır.
+static uint64_t load_flat_image(vm_space_t *vm, const uint8_t *image, uint64_t size)
+{
+    if (!image || !size)
+        return 0;
 
-    paging_map_page_in_pml4(pml4_phys, USER_TEXT_BASE, phys,
-                            AYKEN_PTE_USER | AYKEN_PTE_WRITABLE);
+    if (vm_map_file(vm, USER_TEXT_BASE, size, AYKEN_PTE_WRITABLE, image, size) != 0)
+        return 0;
     return USER_TEXT_BASE;
 }
 
-static uint64_t load_elf_image(uint64_t pml4_phys, const uint8_t *image, uint64_t size)
+#define ELF_PAGE_MASK  (AYKEN_FRAME_SIZE - 1)
+
+static uint64_t load_elf_image(vm_space_t *vm, const uint8_t *image, uint64_t size)
 {
     if (!image || size < sizeof(elf64_ehdr_t))
         return 0;
@@ -91,6 +108,9 @@ static uint64_t load_elf_image(uint64_t pml4_phys, const uint8_t *image, uint64_
     if (ehdr->e_phoff + (uint64_t)ehdr->e_phnum * sizeof(elf64_phdr_t) > size)
         return 0;
 
+    // Bir önceki segment bölgesinin (sayfa hizalı) sonu
+    uint64_t prev_end = 0;
+
     const elf64_phdr_t *phdr = (const elf64_phdr_t *)(image + ehdr->e_phoff);
     for (uint16_t i = 0; i < ehdr->e_phnum; ++i) {
         if (phdr[i].p_type != 1) // PT_LOAD
@@ -101,39 +121,57 @@ static uint64_t load_elf_image(uint64_t pml4_phys, const uint8_t *image, uint64_
         uint64_t memsz  = phdr[i].p_memsz;
         uint64_t vaddr  = phdr[i].p_vaddr;
 
-        for (uint64_t off = 0; off < memsz; off += AYKEN_FRAME_SIZE) {
-            uint64_t phys = phys_alloc_frame();
-            if (!phys)
-                return 0;
+        if (memsz == 0)
+            continue;
+        if ((offset & ELF_PAGE_MASK) != (vaddr & ELF_PAGE_MASK) ||
+            offset > size || filesz > size - offset || filesz > memsz)
+            return 0;
+
+        // Bölge dosya sayfasıyla başlar: sayfanın segment öncesi baytları
+        // da dosyadan gelir (komşu segmentle paylaşılan sayfa).
+        uint64_t skew    = vaddr & ELF_PAGE_MASK;
+        uint64_t start   = vaddr - skew;
+        uint64_t end     = vaddr + memsz;
+        const uint8_t *src = image + offset - skew;
+        uint64_t src_len = skew + filesz;
+
+        // BSS yoksa son sayfanın kalanı da dosyadan (sonraki segment orada olabilir)
+        if (memsz == filesz) {
+            uint64_t page_end = (src_len + ELF_PAGE_MASK) & ~ELF_PAGE_MASK;
+            uint64_t avail    = size - (offset - skew);
+            src_len = page_end < avail ? page_end : avail;
+        }
 
-            uint8_t *dst = (uint8_t *)paging_phys_to_virt(phys);
-            memset(dst, 0, AYKEN_FRAME_SIZE);
+        // Sayfayı önceki segmentle paylaşıyorsa o sayfa önceki bölgede kalır
+        if (start < prev_end) {
+            uint64_t cut = prev_end - start;
+            if (prev_end >= end)
+                continue;
+            start   += cut;
+            src     += cut;
+            src_len  = src_len > cut ? src_len - cut : 0;
+        }
 
-            if (off < filesz) {
-                uint64_t copy = filesz - off < AYKEN_FRAME_SIZE ? (filesz - off) : AYKEN_FRAME_SIZE;
-                if (offset + off + copy <= size)
-                    memcpy(dst, image + offset + off, copy);
-            }
+        if (vm_map_file(vm, start, end - start, AYKEN_PTE_WRITABLE, src, src_len) != 0)
+            return 0;
 
-            paging_map_page_in_pml4(pml4_phys, vaddr + off, phys,
-                                    AYKEN_PTE_USER | AYKEN_PTE_WRITABLE);
-        }
+        prev_end = (end + ELF_PAGE_MASK) & ~ELF_PAGE_MASK;
     }
 
     return ehdr->e_entry;
 }
 
 static uint64_t load_user_image(proc_image_format_t fmt,
-                                uint64_t pml4_phys,
+                                vm_space_t *vm,
                                 const uint8_t *image,
                                 uint64_t size)
 {
     switch (fmt) {
     case PROC_IMAGE_ELF:
-        return load_elf_image(pml4_phys, image, size);
+        return load_elf_image(vm, image, size);
     case PROC_IMAGE_FLAT:
     default:
-        return load_flat_image(pml4_phys, image, size);
+        return load_flat_image(vm, image, size);
     }
 }
 
@@ -141,31 +179,57 @@ void proc_init(void)
 {
     fb_print("[proc] Process subsystem init.\n");
     next_pid = 1;
+
+    if (!g_proc_cache)
+        g_proc_cache = kmem_cache_create("proc", sizeof(proc_t), 0, NULL);
 }
 
-proc_t *proc_create_kernel_thread(void (*func)(void))
+static proc_t *proc_alloc_kernel_thread(void (*func)(void), const char *name)
 {
-    proc_t *p = proc_alloc(PROC_TYPE_KERNEL, "kernel-thread");
+    proc_t *p = proc_alloc(PROC_TYPE_KERNEL, name);
     if (!p) return NULL;
 
-    uint64_t stack = (uint64_t)kmalloc(4096);
-    p->stack_top = stack + 4096;
+    p->stack_top = kstack_alloc();
+    if (!p->stack_top) {
+        proc_free(p);
+        return NULL;
+    }
 
     p->context.rip = (uint64_t)func;
     p->context.rsp = p->stack_top;
     p->context.cr3 = paging_get_kernel_pml4_phys();
+    return p;
+}
+
+proc_t *proc_create_kernel_thread(void (*func)(void))
+{
+    proc_t *p = proc_alloc_kernel_thread(func, "kernel-thread");
+    if (!p) return NULL;
 
     sched_add(p);
     return p;
 }
 
+// Idle öncelikli kernel thread: yalnızca başka hazır iş yokken çalışır.
+proc_t *proc_create_idle_thread(void (*func)(void))
+{
+    proc_t *p = proc_alloc_kernel_thread(func, "idle");
+    if (!p) return NULL;
+
+    sched_set_idle(p);
+    return p;
+}
+
 static proc_t *proc_create_init_process(void)
 {
     proc_t *p = proc_alloc(PROC_TYPE_KERNEL, "init");
     if (!p) return NULL;
 
-    uint64_t stack = (uint64_t)kmalloc(4096);
-    p->stack_top = stack + 4096;
+    p->stack_top = kstack_alloc();
+    if (!p->stack_top) {
+        proc_free(p);
+        return NULL;
+    }
 
     p->context.rip = (uint64_t)init_process_main;
     p->context.rsp = p->stack_top;
@@ -185,26 +249,35 @@ proc_t *proc_create_user_process(const char *name,
         return NULL;
 
     uint64_t user_pml4 = paging_create_user_pml4();
-    if (!user_pml4)
+    if (!user_pml4) {
+        proc_free(p);
         return NULL;
+    }
 
     p->pml4_phys = user_pml4;
     p->context.cr3 = user_pml4;
 
-    uint64_t entry = load_user_image(fmt, user_pml4, image, image_size);
-    if (!entry)
+    p->vm = vm_space_create(user_pml4);
+    if (!p->vm) {
+        proc_free(p);
+        return NULL;
+    }
+
+    uint64_t entry = load_user_image(fmt, p->vm, image, image_size);
+    if (!entry) {
+        proc_free(p);
         return NULL;
+    }
 
-    // Basit user stack: 2 sayfa
-    for (int i = 0; i < 2; ++i) {
-        uint64_t phys = phys_alloc_frame();
-        if (!phys)
-            return NULL;
-        uint64_t virt = USER_STACK_TOP - (i + 1) * AYKEN_FRAME_SIZE;
-        uint8_t *dst = (uint8_t *)paging_phys_to_virt(phys);
-        memset(dst, 0, AYKEN_FRAME_SIZE);
-        paging_map_page_in_pml4(user_pml4, virt, phys,
-                                AYKEN_PTE_USER | AYKEN_PTE_WRITABLE);
+    // User stack: 2 sayfa ile başlar, USER_STACK_MAX'a kadar büyür.
+    // Stack'in kendisindeki #PF IST stack'inde çözülür (interrupts.c);
+    // ilk sayfalar hemen kullanılacağı için yine de önceden oluşturulur.
+    if (vm_map_stack(p->vm, USER_STACK_TOP, 2 * AYKEN_FRAME_SIZE,
+                     USER_STACK_MAX, AYKEN_PTE_WRITABLE) != 0 ||
+        vm_prefault(p->vm, USER_STACK_TOP - 2 * AYKEN_FRAME_SIZE,
+                    2 * AYKEN_FRAME_SIZE) != 0) {
+        proc_free(p);
+        return NULL;
     }
 
     p->stack_top = USER_STACK_TOP;
@@ -215,10 +288,117 @@ proc_t *proc_create_user_process(const char *name,
     return p;
 }
 
+// Template process'i copy-on-write ile çoğaltır: frame'ler paylaşılır,
+// ilk yazmada kopyalanır. Child, parent'ın kaydedilmiş context'inden
+// devam eder; bu yüzden parent o an çalışan process olamaz.
+proc_t *proc_clone(proc_t *parent)
+{
+    if (!parent || parent->type != PROC_TYPE_USER || !parent->vm ||
+        parent == current_proc)
+        return NULL;
+
+    proc_t *p = proc_alloc(PROC_TYPE_USER, parent->name);
+    if (!p)
+        return NULL;
+
+    uint64_t user_pml4 = paging_create_user_pml4();
+    if (!user_pml4) {
+        proc_free(p);
+        return NULL;
+    }
+
+    p->pml4_phys = user_pml4;
+    p->vm = vm_space_clone(parent->vm, user_pml4);
+
+    // Parent'ın sayfaları salt okunur oldu; TLB'de yazılabilir girişi
+    // kalmasın diye bir sonraki yüklemede yeni PCID alır.
+    parent->pcid_gen = 0;
+
+    if (!p->vm) {
+        proc_free(p);
+        return NULL;
+    }
+
+    p->context     = parent->context;
+    p->context.cr3 = user_pml4;
+    p->stack_top   = parent->stack_top;
+
+    sched_add(p);
+    return p;
+}
+
+#if AYKEN_CLONE_SELFTEST
+// Sayaç (imaj sayfası, COW paylaşılır) ve stack (kopyalanır) yazılır,
+// yield edilir, ikisi geri okunur; sayaç 1 ve stack değeri 0x5A ise
+// SYS_EXIT(0). Taraflardan biri diğerinin yazmasını görürse status != 0.
+//
+//   inc  qword [rip+counter]      push 0x5A
+//   mov  eax, SYS_YIELD; int 0x80 pop  rdi; sub rdi, 0x5A
+//   mov  rax, [rip+counter]; dec rax; or rdi, rax
+//   mov  eax, SYS_EXIT; int 0x80  jmp $
+//   counter: dq 0
+static const uint8_t clone_test_image[] = {
+    0x48, 0xFF, 0x05, 0x29, 0x00, 0x00, 0x00, 0x6A, 0x5A, 0xB8, 0x04, 0x00,
+    0x00, 0x00, 0xCD, 0x80, 0x5F, 0x48, 0x83, 0xEF, 0x5A, 0x48, 0x8B, 0x05,
+    0x14, 0x00, 0x00, 0x00, 0x48, 0xFF, 0xC8, 0x48, 0x09, 0xC7, 0xB8, 0x03,
+    0x00, 0x00, 0x00, 0xCD, 0x80, 0xEB, 0xFE, 0x0F, 0x1F, 0x44, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static void proc_clone_selftest(void)
+{
+    int status[2] = { PROC_EXIT_PENDING, PROC_EXIT_PENDING };
+    proc_t *procs[2];
+
+    // Parent klonlanmadan önce çalışmasın; kesmeler kapalıyken kontrol +
+    // block, çıkış uyandırmasını kaçırmaz (sched_block_current IF'i korur).
+    uint64_t irq = cpu_irq_save();
+
+    procs[0] = proc_create_user_process("clone-test", clone_test_image,
+                                        sizeof(clone_test_image), PROC_IMAGE_FLAT);
+    procs[1] = NULL;
+
+    // İmaj sayfası parent'ta oluşsun ki child'la COW paylaşılsın
+    if (procs[0] &&
+        vm_prefault(procs[0]->vm, USER_TEXT_BASE, sizeof(clone_test_image)) == 0)
+        procs[1] = proc_clone(procs[0]);
+
+    for (int i = 0; i < 2; ++i) {
+        if (procs[i])
+            procs[i]->exit_status = &status[i];
+    }
+
+    for (int i = 0; i < 2; ++i) {
+        while (procs[i] && status[i] == PROC_EXIT_PENDING)
+            proc_block_current(&status[i]);
+    }
+
+    cpu_irq_restore(irq);
+
+    if (procs[1] && status[0] == 0 && status[1] == 0)
+        fb_print("[proc] clone self-test passed.\n");
+    else
+        fb_print("[proc] clone self-test FAILED.\n");
+}
+#endif
+
 // PID 1: init process
 void init_process_main(void)
 {
     fb_print("[init] PID1 running.\n");
+
+    // Artık boot stack'inde değiliz ve boot_info/memory map'e ihtiyaç yok:
+    // UEFI boot-services + loader belleğini allocator'a geri ver.
+    phys_mem_reclaim_boot_memory();
+
+#if AYKEN_MM_STATS
+    mm_stats_dump();
+#endif
+
+#if AYKEN_CLONE_SELFTEST
+    proc_clone_selftest();
+#endif
+
     proc_launch_user_ai_service();
     for(;;) {
         sched_yield();
@@ -259,3 +439,31 @@ void proc_wake_waiters(void *wait_obj)
 {
     sched_wake_all(wait_obj);
 }
+
+// sched_exit_current ile çıkmış process: scheduler onu artık hiçbir
+// kuyrukta tutmuyor ve adres alanı yüklü değil.
+void proc_reap(proc_t *p)
+{
+    if (p)
+        proc_free(p);
+}
+
+void proc_exit_current(int status)
+{
+    proc_t *p = current_proc;
+
+    fb_print("[proc] ");
+    fb_print(p->name);
+    fb_print(" (pid ");
+    fb_print_uint((uint64_t)p->pid);
+    fb_print(") exited with status ");
+    fb_print_int(status);
+    fb_print("\n");
+
+    if (p->exit_status) {
+        *p->exit_status = status;
+        proc_wake_waiters(p->exit_status);
+    }
+
+    sched_exit_current();
+}
@@ -10,8 +10,23 @@ static proc_t *ready_head = NULL;
 static proc_t *ready_tail = NULL;
 static proc_t *blocked_head = NULL;
 
+// Çıkmış process'ler: kendi stack'leri üzerindeyken serbest
+// bırakılamazlar; bir sonraki geçişten sonra başka bir stack'ten toplanır.
+static proc_t *zombie_head = NULL;
+
+// Idle öncelikli thread: ready kuyruğunda hiç iş yokken çalışır,
+// kendisi hiçbir zaman ready kuyruğuna girmez.
+static proc_t *idle_proc = NULL;
+
 proc_t *current_proc = NULL;
 
+// Geçilecek process'in CR3 değeri: PCID etiketli ve mümkünse no-flush.
+// Aynı adres alanına geçişte context_switch CR3'e hiç yazmaz.
+static inline void sched_prepare_cr3(proc_t *p)
+{
+    p->context.cr3 = paging_asid_cr3(p->pml4_phys, &p->pcid, &p->pcid_gen);
+}
+
 static void enqueue_ready(proc_t *p)
 {
     p->next = NULL;
@@ -55,10 +70,24 @@ static void remove_from_blocked(proc_t *p)
     }
 }
 
+// Yalnızca context_switch dönüşünden sonra (başka bir process'in
+// stack'inde, kesmeler kapalı) çağrılır.
+static void sched_reap_zombies(void)
+{
+    while (zombie_head) {
+        proc_t *p = zombie_head;
+        zombie_head = p->next;
+        p->next = NULL;
+        proc_reap(p);
+    }
+}
+
 void sched_init(void)
 {
     ready_head = ready_tail = NULL;
     blocked_head = NULL;
+    zombie_head = NULL;
+    idle_proc = NULL;
     current_proc = NULL;
 }
 
@@ -66,6 +95,8 @@ void sched_start(void)
 {
     disable_interrupts();
     proc_t *first = dequeue_ready();
+    if (!first)
+        first = idle_proc;
     if (!first) {
         enable_interrupts();
         return;
@@ -74,24 +105,34 @@ void sched_start(void)
     current_proc = first;
     current_proc->state = PROC_RUNNING;
 
-    paging_load_cr3(current_proc->context.cr3);
+    sched_prepare_cr3(current_proc);
     enable_interrupts();
     switch_to_first(&current_proc->context);
 }
 
+// yield/block çağıranın IF durumunu korur: timer ISR'ından (IF=0)
+// çağrıldıysa kesmeler iretq'ya kadar kapalı kalır, geri dönen process
+// ise kendi kaydettiği durumla devam eder.
 void sched_yield(void)
 {
-    disable_interrupts();
+    uint64_t irq = cpu_irq_save();
 
     proc_t *prev = current_proc;
     proc_t *next = dequeue_ready();
 
+    // Hazır iş yoksa idle thread'e geç (sıfır havuzu orada dolar);
+    // idle'ın kendisi yield ettiğinde çalışmaya devam eder.
+    if (!next && prev != idle_proc)
+        next = idle_proc;
+
     if (!next) {
-        enable_interrupts();
+        cpu_irq_restore(irq);
         return;
     }
 
-    if (prev && prev->state == PROC_RUNNING) {
+    if (prev && prev == idle_proc) {
+        prev->state = PROC_READY;
+    } else if (prev && prev->state == PROC_RUNNING) {
         prev->state = PROC_READY;
         enqueue_ready(prev);
     }
@@ -99,7 +140,7 @@ void sched_yield(void)
     current_proc = next;
     current_proc->state = PROC_RUNNING;
 
-    paging_load_cr3(current_proc->context.cr3);
+    sched_prepare_cr3(current_proc);
 
     if (prev) {
         context_switch(&prev->context, &current_proc->context);
@@ -107,16 +148,17 @@ void sched_yield(void)
         switch_to_first(&current_proc->context);
     }
 
-    enable_interrupts();
+    sched_reap_zombies();
+    cpu_irq_restore(irq);
 }
 
 void sched_block_current(void)
 {
-    disable_interrupts();
+    uint64_t irq = cpu_irq_save();
 
     proc_t *prev = current_proc;
     if (!prev) {
-        enable_interrupts();
+        cpu_irq_restore(irq);
         return;
     }
 
@@ -124,17 +166,55 @@ void sched_block_current(void)
     enqueue_blocked(prev);
 
     proc_t *next = dequeue_ready();
+    if (!next)
+        next = idle_proc;
     if (!next) {
-        enable_interrupts();
+        cpu_irq_restore(irq);
         return;
     }
 
     current_proc = next;
     current_proc->state = PROC_RUNNING;
-    paging_load_cr3(current_proc->context.cr3);
+    sched_prepare_cr3(current_proc);
     context_switch(&prev->context, &current_proc->context);
 
-    enable_interrupts();
+    sched_reap_zombies();
+    cpu_irq_restore(irq);
+}
+
+void sched_exit_current(void)
+{
+    disable_interrupts();
+
+    proc_t *prev = current_proc;
+    proc_t *next = dequeue_ready();
+    if (!next)
+        next = idle_proc;
+
+    // Çalışacak başka hiçbir şey yok: yield döngüsü de dönemezdi
+    if (!next || next == prev) {
+        for (;;)
+            __asm__ volatile("hlt");
+    }
+
+    if (prev) {
+        prev->state = PROC_ZOMBIE;
+        prev->next  = zombie_head;
+        zombie_head = prev;
+    }
+
+    current_proc = next;
+    current_proc->state = PROC_RUNNING;
+    sched_prepare_cr3(current_proc);
+
+    // prev bir daha seçilmez; context'i yalnızca kaydedilip bırakılır
+    if (prev)
+        context_switch(&prev->context, &current_proc->context);
+    else
+        switch_to_first(&current_proc->context);
+
+    for (;;)
+        __asm__ volatile("hlt");
 }
 
 void sched_wake(proc_t *proc)
@@ -168,6 +248,14 @@ void sched_add(proc_t *proc)
     enqueue_ready(proc);
 }
 
+void sched_set_idle(proc_t *proc)
+{
+    if (!proc)
+        return;
+    proc->state = PROC_READY;
+    idle_proc = proc;
+}
+
 void sched_add_task(void *task)
 {
     (void)task;
@@ -8,9 +8,14 @@
 // Scheduler API
 void sched_init(void);
 void sched_add(proc_t *proc);
+void sched_set_idle(proc_t *proc);
 void sched_yield(void);
 void sched_start(void);
 void sched_block_current(void);
+// Çalışan process'i sonlandırır (kesmeler kapalıyken de güvenli); ready
+// kuyruğundaki sıradakine ya da idle'a geçer ve geri dönmez. Process
+// bir sonraki geçişten sonra proc_reap ile serbest bırakılır.
+void sched_exit_current(void) __attribute__((noreturn));
 void sched_wake(proc_t *proc);
 void sched_wake_all(void *wait_obj);
 
@@ -2,8 +2,13 @@
 // System call stub implementation
 
 #include <stdint.h>
+#include <stddef.h>
 #include "../arch/x86_64/interrupts.h"
 #include "../drivers/console/fb_console.h"
+#include "../include/syscall.h"
+#include "../include/mm.h"
+#include "../include/proc.h"
+#include "../sched/sched.h"
 
 // Basit INT 0x80 giriş noktası
 __attribute__((interrupt)) void syscall_isr(struct interrupt_frame *frame)
@@ -30,12 +35,34 @@ void syscall_init(void)
 uint64_t syscall_handler(uint64_t syscall_num, uint64_t arg1,
                          uint64_t arg2, uint64_t arg3, uint64_t arg4)
 {
-    // TODO: Implement syscall dispatch
-    (void)syscall_num;
-    (void)arg1;
-    (void)arg2;
-    (void)arg3;
     (void)arg4;
 
-    return (uint64_t)-1; // ENOSYS
+    vm_space_t *vm = current_proc ? current_proc->vm : NULL;
+
+    switch (syscall_num) {
+    case SYS_MMAP: {
+        if (!vm)
+            return (uint64_t)-1;
+        uint64_t flags = (arg3 & SYS_PROT_WRITE) ? AYKEN_PTE_WRITABLE : 0;
+        uint64_t addr  = vm_mmap(vm, arg1, arg2, flags);
+        return addr ? addr : (uint64_t)-1;
+    }
+
+    case SYS_MUNMAP:
+        if (!vm)
+            return (uint64_t)-1;
+        return vm_munmap(vm, arg1, arg2) == 0 ? 0 : (uint64_t)-1;
+
+    case SYS_EXIT:
+        if (!current_proc || current_proc->type != PROC_TYPE_USER)
+            return (uint64_t)-1;
+        proc_exit_current((int)arg1);
+
+    case SYS_YIELD:
+        sched_yield();
+        return 0;
+
+    default:
+        return (uint64_t)-1; // ENOSYS
+    }
 }